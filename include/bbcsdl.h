@@ -25,6 +25,7 @@
 #define	SOUNDQE         4       // Number of bytes per sound entry
 #define SOUNDQL         5*SOUNDQE // Number of bytes per channel
 #define MAX_EVENTS	512	// Maximum SDL events to queue
+#define VDURING		4096	// VDU commands in ring (power of 2)
 #define MAX_TEMPO	10	// Maximum (slowest) *TEMPO setting
 
 // User-defined message IDs:
@@ -37,7 +38,7 @@
 
 // Custom user-event IDs:
 
-#define EVT_VDU		0x2000	// Send a VDU command
+#define EVT_VDU		0x2000	// VDU character / drain VDU ring
 #define EVT_COPYKEY	0x2001	// Handle 'copy key' actions
 #define EVT_TINT	0x2002	// Get RGB pixel value
 #define EVT_DISPLAY	0x2003	// *DISPLAY command
@@ -149,6 +150,22 @@ typedef struct tagRND
 	unsigned char h ;
 } RND, *LPRND ;
 
+typedef struct tagVDUCMD
+{
+	int code ;   // EVT_VDU or VDU code
+	void *data1 ;
+	void *data2 ;
+} VDUCMD, *LPVDUCMD ;
+
+#if !SDL_VERSION_ATLEAST(2,0,18)
+typedef struct SDL_Vertex	// Layout of SDL_RenderGeometry vertices
+{
+	struct { float x, y ; } position ;
+	SDL_Color color ;
+	struct { float x, y ; } tex_coord ;
+} SDL_Vertex ;
+#endif
+
 // Variables declared in bbcsdl.c:
 extern SDL_Renderer *memhdc ;
 extern SDL_Window *hwndProg ;
@@ -272,6 +289,10 @@ extern unsigned int vcount ;    // Character count since newline
 // Declared in bbcsdl.c:
 extern size_t iResult ;		// Result from user event
 extern int nUserEv ;		// Number of pending user events
+extern VDUCMD vduring[] ;	// VDU command ring (interpreter to GUI)
+extern SDL_atomic_t vduhead ;	// VDU ring write index
+extern SDL_atomic_t vdutail ;	// VDU ring read index
+extern SDL_atomic_t vduwake ;	// VDU ring wake-up event pending
 extern int OSKtime ;		// On-screen keyboard timeout
 extern SDL_sem *Sema4 ;		// Semaphore for user event wait
 extern SDL_mutex *Mutex ;	// Mutex to protect event queue
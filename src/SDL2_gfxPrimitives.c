@@ -3280,6 +3280,42 @@ static Uint32 charZoomY = 1;
 */
 static Uint32 charSize = 8;
 
+/*!
+\brief Atlas texture holding the 256 characters of the current font in a
+16 x 16 grid, so that runs of text can be drawn from a single texture.
+*/
+static SDL_Texture *gfxPrimitivesAtlas;
+static Uint8 atlasValid[256];
+static Uint8 atlasFailed;
+
+/*!
+\brief Characters changed by RedefineChar(): 1 if the pattern (in charPattern)
+is the size of the current font, 2 if not (drawn only by characterRGBA).
+*/
+static Uint8 charRedefined[256];
+static unsigned char charPattern[256][40];
+
+/*!
+\brief Discard the cached character textures and the atlas.
+*/
+static void clearCharacterCache(void)
+{
+	int i;
+
+	for (i = 0; i < 256; i++) {
+		if (gfxPrimitivesFont[i]) {
+			SDL_DestroyTexture(gfxPrimitivesFont[i]);
+			gfxPrimitivesFont[i] = NULL;
+		}
+	}
+	if (gfxPrimitivesAtlas) {
+		SDL_DestroyTexture(gfxPrimitivesAtlas);
+		gfxPrimitivesAtlas = NULL;
+	}
+	memset(charRedefined, 0, sizeof(charRedefined));
+	atlasFailed = 0;
+}
+
 /*!
 \brief Sets or resets the current global font data.
 
@@ -3295,8 +3331,6 @@ The font data array is organized in follows:
 */
 void gfxPrimitivesSetFont(const void *fontdata, Uint32 cw, Uint32 ch)
 {
-	int i;
-
 	if ((fontdata) && (cw) && (ch)) {
 		currentFontdata = (unsigned char *)fontdata;
 		charWidth = cw;
@@ -3323,12 +3357,7 @@ void gfxPrimitivesSetFont(const void *fontdata, Uint32 cw, Uint32 ch)
 	}
 
 	/* Clear character cache */
-	for (i = 0; i < 256; i++) {
-		if (gfxPrimitivesFont[i]) {
-			SDL_DestroyTexture(gfxPrimitivesFont[i]);
-			gfxPrimitivesFont[i] = NULL;
-		}
-	}
+	clearCharacterCache();
 }
 
 const void *gfxPrimitivesGetFont(void)
@@ -3346,8 +3375,6 @@ Changing the rotation, will reset the character cache.
 */
 void gfxPrimitivesSetFontRotation(Uint32 rotation)
 {
-	int i;
-
 	rotation = rotation & 3;
 	if (charRotation != rotation)
 	{
@@ -3367,28 +3394,146 @@ void gfxPrimitivesSetFontRotation(Uint32 rotation)
 		}
 
 		/* Clear character cache */
-		for (i = 0; i < 256; i++) {
-			if (gfxPrimitivesFont[i]) {
-				SDL_DestroyTexture(gfxPrimitivesFont[i]);
-				gfxPrimitivesFont[i] = NULL;
-			}
-		}
+		clearCharacterCache();
 	}
 }
 
 void gfxPrimitivesSetFontZoom(Uint32 zoomx, Uint32 zoomy)
 {
-	int i;
-
 	charZoomX = zoomx ;
 	charZoomY = zoomy ;
 	/* Clear character cache */
-	for (i = 0; i < 256; i++) {
-		if (gfxPrimitivesFont[i]) {
-			SDL_DestroyTexture(gfxPrimitivesFont[i]);
-			gfxPrimitivesFont[i] = NULL;
+	clearCharacterCache();
+}
+
+/*!
+\brief Render a character pattern of the current font size to a surface,
+zoomed and rotated as currently set.
+
+\returns Returns the new surface, or NULL on failure.
+*/
+static SDL_Surface *renderCharacter(const unsigned char *charpos)
+{
+	Uint32 ix, iy;
+	Uint8 *curpos;
+	Uint8 patt, mask;
+	Uint8 *linepos;
+	Uint32 pitch;
+	SDL_Surface *character;
+	SDL_Surface *rotatedCharacter;
+	SDL_Surface *zoomedCharacter;
+
+	character =	SDL_CreateRGBSurface(SDL_SWSURFACE,
+		charWidth, charHeight, 32,
+		0xFF000000, 0x00FF0000, 0x0000FF00, 0x000000FF);
+	if (character == NULL) {
+		return (NULL);
+	}
+
+	linepos = (Uint8 *)character->pixels;
+	pitch = character->pitch;
+
+	/*
+	* Drawing loop 
+	*/
+	patt = 0;
+	for (iy = 0; iy < charHeight; iy++) {
+		mask = 0x00;
+		curpos = linepos;
+		for (ix = 0; ix < charWidth; ix++) {
+			if (!(mask >>= 1)) {
+				patt = *charpos++;
+				mask = 0x80;
+			}
+			if (patt & mask) {
+				*(Uint32 *)curpos = 0xffffffff;
+			} else {
+				*(Uint32 *)curpos = 0;
+			}
+			curpos += 4;
 		}
+		linepos += pitch;
+	}
+
+	/* Maybe zoom character */
+	if ((charZoomX != 1) || (charZoomY != 1))
+	{
+		zoomedCharacter = zoomSurface(character, (double)charZoomX, 
+                                                          (double)charZoomY, SMOOTHING_OFF);
+		SDL_FreeSurface(character);
+		character = zoomedCharacter;
+	}
+
+	/* Maybe rotate */
+	if ((character) && (charRotation>0))
+	{
+		rotatedCharacter = rotateSurface90Degrees(character, charRotation);
+		SDL_FreeSurface(character);
+		character = rotatedCharacter;
 	}
+
+	return (character);
+}
+
+/*!
+\brief Get the atlas texture and the source rectangle of a character of the
+current font, adding the character to the atlas if necessary.
+
+\param renderer The renderer to draw on.
+\param c The character.
+\param srect Receives the character's rectangle in the atlas.
+\param w Receives the width of the atlas.
+\param h Receives the height of the atlas.
+
+\returns Returns the atlas texture, or NULL if the character must be drawn
+using characterRGBA() instead.
+*/
+SDL_Texture *characterAtlas(SDL_Renderer *renderer, char c, SDL_Rect *srect, int *w, int *h)
+{
+	SDL_Surface *character;
+	Uint32 ci = (unsigned char) c;
+	int cw = charWidthLocal * charZoomX;
+	int ch = charHeightLocal * charZoomY;
+
+	if (charRedefined[ci] == 2)
+		return (NULL);
+
+	if (gfxPrimitivesAtlas == NULL) {
+		if (atlasFailed)
+			return (NULL);
+		gfxPrimitivesAtlas = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888,
+			SDL_TEXTUREACCESS_STATIC, cw * 16, ch * 16);
+		if (gfxPrimitivesAtlas == NULL) {
+			atlasFailed = 1;
+			return (NULL);
+		}
+		SDL_SetTextureBlendMode(gfxPrimitivesAtlas, SDL_BLENDMODE_BLEND);
+		memset(atlasValid, 0, sizeof(atlasValid));
+	}
+
+	srect->x = (ci & 15) * cw;
+	srect->y = (ci >> 4) * ch;
+	srect->w = cw;
+	srect->h = ch;
+	*w = cw * 16;
+	*h = ch * 16;
+
+	if (!atlasValid[ci]) {
+		character = renderCharacter(charRedefined[ci] ? charPattern[ci] :
+			currentFontdata + ci * charSize);
+		if (character == NULL)
+			return (NULL);
+		if ((character->w != cw) || (character->h != ch) ||
+		    (character->format->format != SDL_PIXELFORMAT_RGBA8888) ||
+		    (SDL_UpdateTexture(gfxPrimitivesAtlas, srect, character->pixels, character->pitch))) {
+			SDL_FreeSurface(character);
+			return (NULL);
+		}
+		SDL_FreeSurface(character);
+		atlasValid[ci] = 1;
+	}
+
+	return (gfxPrimitivesAtlas);
 }
 
 /*!
@@ -3410,15 +3555,7 @@ int characterRGBA(SDL_Renderer *renderer, Sint16 x, Sint16 y, char c, Uint8 r, U
 	SDL_Rect srect;
 	SDL_Rect drect;
 	int result;
-	Uint32 ix, iy;
-	const unsigned char *charpos;
-	Uint8 *curpos;
-	Uint8 patt, mask;
-	Uint8 *linepos;
-	Uint32 pitch;
 	SDL_Surface *character;
-	SDL_Surface *rotatedCharacter;
-	SDL_Surface *zoomedCharacter;
 	Uint32 ci;
 
 	/*
@@ -3445,59 +3582,11 @@ int characterRGBA(SDL_Renderer *renderer, Sint16 x, Sint16 y, char c, Uint8 r, U
 	* Might get rotated later.
 	*/
 	if (gfxPrimitivesFont[ci] == NULL) {
-		/*
-		* Redraw character into surface
-		*/
-		character =	SDL_CreateRGBSurface(SDL_SWSURFACE,
-			charWidth, charHeight, 32,
-			0xFF000000, 0x00FF0000, 0x0000FF00, 0x000000FF);
+		character = renderCharacter(currentFontdata + ci * charSize);
 		if (character == NULL) {
 			return (-1);
 		}
 
-		charpos = currentFontdata + ci * charSize;
-				linepos = (Uint8 *)character->pixels;
-		pitch = character->pitch;
-
-		/*
-		* Drawing loop 
-		*/
-		patt = 0;
-		for (iy = 0; iy < charHeight; iy++) {
-			mask = 0x00;
-			curpos = linepos;
-			for (ix = 0; ix < charWidth; ix++) {
-				if (!(mask >>= 1)) {
-					patt = *charpos++;
-					mask = 0x80;
-				}
-				if (patt & mask) {
-					*(Uint32 *)curpos = 0xffffffff;
-				} else {
-					*(Uint32 *)curpos = 0;
-				}
-				curpos += 4;
-			}
-			linepos += pitch;
-		}
-
-		/* Maybe zoom character */
-		if ((charZoomX != 1) || (charZoomY != 1))
-		{
-			zoomedCharacter = zoomSurface(character, (double)charZoomX, 
-                                                          (double)charZoomY, SMOOTHING_OFF);
-			SDL_FreeSurface(character);
-			character = zoomedCharacter;
-		}
-
-		/* Maybe rotate and replace cached image */
-		if (charRotation>0)
-		{
-			rotatedCharacter = rotateSurface90Degrees(character, charRotation);
-			SDL_FreeSurface(character);
-			character = rotatedCharacter;
-		}
-
 		/* Convert temp surface into texture */
 		gfxPrimitivesFont[ci] = SDL_CreateTextureFromSurface(renderer, character);
 		SDL_FreeSurface(character);
@@ -4246,6 +4335,16 @@ int RedefineChar(SDL_Renderer *renderer, char c, unsigned char *charpos, Uint32
 
 	if (gfxPrimitivesFont[ci] != NULL)
 		SDL_DestroyTexture (gfxPrimitivesFont[ci]) ;
+
+	// Remember the pattern for the atlas
+	if ((width == charWidth) && (height == charHeight) && (charSize <= sizeof(charPattern[0])))
+	{
+		memcpy (charPattern[ci], charpos, charSize) ;
+		charRedefined[ci] = 1 ;
+	}
+	else
+		charRedefined[ci] = 2 ;
+	atlasValid[ci] = 0 ;
 		
 	// Redraw character into surface
 	character = SDL_CreateRGBSurface(SDL_SWSURFACE, width, height, 32,
@@ -24,7 +24,7 @@
 #include "SDL_stbimage.h"
 
 #undef MAX_PATH
-#define NCMDS 51	// number of OSCLI commands
+#define NCMDS 53	// number of OSCLI commands
 #define POWR2 32	// largest power-of-2 less than NCMDS
 #define COPYBUFLEN 4096	// length of buffer used for *COPY command
 #define _S_IWRITE 0x0080
@@ -45,22 +45,28 @@ void listline (signed char*, int*) ;
 void quiet (void) ;
 void getcsr (int*, int*) ;
 void SetErrorBBC (void) ;
+void profile (int) ;
+int profsave (const char *) ;
+
+// Global variables:
+extern unsigned char fastxq ;	// *TURBO mode (per-site variable cache)
+extern int filbufsz ;		// File channel buffer size in KB (*FX 254)
 
 static char *cmds[NCMDS] = {
 		"bye", "cd", "chdir", "copy", "del", "delete", "dir", "display",
 		"dump", "ega", "era", "erase", "esc", "exec", "float", "font", "fx",
 		"gsave", "help", "hex", "input", "key", "list", "load", "lock", "lowercase",
-		"md", "mdisplay", "mkdir", "noega", "osk", "output", "quit", "rd", "refresh",
+		"md", "mdisplay", "mkdir", "noega", "osk", "output", "profile", "quit", "rd", "refresh",
 		"ren", "rename", "rmdir", "run", "save", "screensave", "spool", "spoolon",
-		"stereo", "sys", "tempo", "timer", "tv", "type", "unlock", "voice"} ;
+		"stereo", "sys", "tempo", "timer", "turbo", "tv", "type", "unlock", "voice"} ;
 
 enum {
 		BYE, CD, CHDIR, COPY, DEL, DELETE, DIRCMD, DISPLAY,
 		DUMP, EGA, ERA, ERASE, ESC, EXEC, FLOAT, FONT, FX,
 		GSAVE, HELP, HEX, INPUT, KEY, LIST, LOAD, LOCK, LOWERCASE,
-		MD, MDISPLAY, MKDIR, NOEGA, OSK, OUTPUT, QUIT, RD, REFRESH,
+		MD, MDISPLAY, MKDIR, NOEGA, OSK, OUTPUT, PROFILE, QUIT, RD, REFRESH,
 		REN, RENAME, RMDIR, RUN, SAVE, SCREENSAVE, SPOOL, SPOOLON,
-		STEREO, SYS, TEMPO, TIMER, TV, TYPE, UNLOCK, VOICE} ;
+		STEREO, SYS, TEMPO, TIMER, TURBO, TV, TYPE, UNLOCK, VOICE} ;
 
 static int BBC_RWclose (struct SDL_RWops* context)
 {
@@ -549,6 +555,12 @@ void oscli (char *cmd)
 				while (reflag & 1)
 					SDL_Delay (1) ;
 			    }
+			else if (n == 254)
+			    {
+				if ((b < 0) || (b > 0x10000))
+					error (254, "Bad command") ;
+				filbufsz = b ;
+			    }
 			else if (n == 21)
 			    {
 				if (b == 0)
@@ -931,6 +943,10 @@ void oscli (char *cmd)
 			pushev (EVT_TIMER, (void *)(intptr_t) n, NULL) ;
 			return ;
 
+		case TURBO:
+			fastxq = onoff (p) ;
+			return ;
+
 		case TV:
 			return ;		// ignored
 
@@ -984,6 +1000,20 @@ void oscli (char *cmd)
 			optval = (optval & 0xF0) | (n & 0x0F) ;
 			return ;
 
+		case PROFILE:			// *PROFILE ON|OFF|filename
+			if (((*p & 0x5F) == 'O') && ((*(p + 1) & 0x5F) == 'N') && (*(p + 2) <= ' '))
+				profile (1) ;
+			else if (((*p & 0x5F) == 'O') && ((*(p + 1) & 0x5F) == 'F') &&
+				 ((*(p + 2) & 0x5F) == 'F') && (*(p + 3) <= ' '))
+				profile (0) ;
+			else
+			    {
+				setup (path1, p, ".txt", ' ', NULL) ;
+				if ((*path1 == 0) || !profsave (path1))
+					error (189, "Couldn't create file") ;
+			    }
+			return ;
+
 		case DUMP:
 			p = setup (path1, p, ".bbc", ' ', NULL) ;
 			srcfile = SDL_RWFromFile (path1, "rb") ;
@@ -108,6 +108,7 @@ char *setup (char *, char *, char *, char, unsigned char *) ;
 
 // Declared in bbmain.c:
 void error (int, const char *) ;
+void *sysint (char *) ;		// Get address of interpreter function
 void text (const char *) ;	// Output NUL-terminated string
 void crlf (void) ;		// Output a newline
 
@@ -460,6 +461,13 @@ int vpoint (int x, int y)
 	return -1 ;
 }
 
+// Read a rectangle of pixels:
+int readpix (int x, int y, int w, int h, int *buf, int pal)
+{
+	error (255, "Sorry, not implemented") ;
+	return 0 ;
+}
+
 int vgetc (int x, int y)
 {
 	error (255, "Sorry, not implemented") ;
@@ -609,7 +617,10 @@ heapptr xtrap (void)
 {
 	trap () ;
 	if (flags & ALERT)
+	    {
+		fflush (stdout) ; // periodic timer tick or event
 		return getevt () ;
+	    }
 	return 0 ;
 }
 
@@ -664,6 +675,7 @@ int oskey (int wait)
 	if (wait >= 0)
 	    {
 		unsigned int start = GetTicks () ;
+		fflush (stdout) ;
 		while (1)
 		    {
 			unsigned char key ;
@@ -697,6 +709,7 @@ unsigned char osrdch (void)
 	if (optval >> 4)
 		return osbget ((void *)(size_t)(optval >> 4), NULL) ;
 
+	fflush (stdout) ;
 	while (!rdkey (&key))
 	{
 		usleep (5000) ;
@@ -740,7 +753,6 @@ void oswrch (unsigned char vdu)
 			pqueue -= ecx - 9 ;
 				for ( ; ecx > 0 ; ecx--)
 					xeqvdu (*pqueue++ << 8, 0, 0) ;
-			fflush (stdout) ;
 			return ;
 		    }
 	    }
@@ -755,7 +767,6 @@ void oswrch (unsigned char vdu)
 			return ;
 		    }
 		xeqvdu (vdu << 8, 0, 0) ;
-		fflush (stdout) ;
 		return ;
 	    }
 	else
@@ -1078,7 +1089,7 @@ void mouseto (int x, int y)
 // Get address of an API function:
 void *sysadr (char *name)
 {
-	void *addr = NULL ;
+	void *addr = sysint (name) ;
 	if (addr != NULL)
 		return addr ; 
 	return dlsym (RTLD_DEFAULT, name) ;
@@ -1195,6 +1206,21 @@ void ossave (char *p, void *addr, int len)
 		error (189, "Couldn't write to file") ;
 }
 
+// Per-channel stdio buffers, sized in KB by *FX 254 (0 = system default):
+int filbufsz = 64 ;
+static char *iobuf[MAX_PORTS + MAX_FILES + 1] ;
+
+// Channels opened by OPENIN, and those mapped into memory by mapfile:
+static unsigned char inonly[MAX_PORTS + MAX_FILES + 1] ;
+static struct { unsigned char *base ; long long size ; long long ptr ; } fmap[MAX_PORTS + MAX_FILES + 1] ;
+
+// Test for a memory-mapped channel:
+static int mapped (void *chan)
+{
+	return (chan > (void *)MAX_PORTS) && (chan <= (void *)(MAX_PORTS+MAX_FILES)) &&
+		(fmap[(size_t) chan].base != NULL) ;
+}
+
 // Open a file:
 void *osopen (int type, char *p)
 {
@@ -1231,8 +1257,13 @@ void *osopen (int type, char *p)
 		if (filbuf[chan] == 0)
 		    {
 			filbuf[chan] = file ;
+			inonly[chan] = (type == 0) ;
 			if (chan > MAX_PORTS)
+			    {
 				*(int *)&fcbtab[chan - MAX_PORTS - 1] = 0 ;
+				if (filbufsz && ((iobuf[chan] = malloc (filbufsz << 10)) != NULL))
+					setvbuf (file, iobuf[chan], _IOFBF, filbufsz << 10) ;
+			    }
 			return (void *)(size_t)chan ;
 		    }
 	    }
@@ -1303,10 +1334,23 @@ static int closeb (void *chan)
 		FILE *handle = (FILE *) filbuf[(size_t) chan] ;
 		if (writeb (handle, buffer, pfcb))
 			return 1 ;
+		if (mapped (chan))
+		    {
+#ifdef _WIN32
+			UnmapViewOfFile (fmap[(size_t) chan].base) ;
+#else
+			munmap (fmap[(size_t) chan].base, fmap[(size_t) chan].size) ;
+#endif
+			fmap[(size_t) chan].base = NULL ;
+		    }
 	    }
 	result = fclose (lookup (chan)) ;
 	if ((chan >= (void *)1) && (chan <= (void *)(MAX_PORTS + MAX_FILES)))
+	    {
 		filbuf[(size_t)chan] = 0 ;
+		free (iobuf[(size_t)chan]) ;
+		iobuf[(size_t)chan] = NULL ;
+	    }
 	return result ;
 }
 
@@ -1326,6 +1370,17 @@ unsigned char osbget (void *chan, int *peof)
 #endif
 		return byte ;
 	    }
+	if (mapped (chan))
+	    {
+		size_t n = (size_t) chan ;
+		if ((fmap[n].ptr >= fmap[n].size) || (fmap[n].ptr < 0))
+		    {
+			if (peof != NULL)
+				*peof = 1 ;
+			return 0 ;
+		    }
+		return fmap[n].base[fmap[n].ptr++] ;
+	    }
 	if ((chan > (void *)MAX_PORTS) && (chan <= (void *)(MAX_PORTS+MAX_FILES)))
 	    {
 		int index = (size_t) chan - MAX_PORTS - 1 ;
@@ -1351,6 +1406,102 @@ unsigned char osbget (void *chan, int *peof)
 	return byte ;
 }
 
+// Find the first terminator, as specified by GET$# TO term, in a block:
+static unsigned char *termscan (unsigned char *p, int len, int term)
+{
+	unsigned char *q, *r ;
+	if (term < 0)
+		return NULL ;
+	q = memchr (p, term & 0xFF, len) ;
+	if (q)
+		len = q - p ;
+	if ((term & 0x8100) && ((r = memchr (p, 0x0D, len)) != NULL))
+	    {
+		q = r ;
+		len = q - p ;
+	    }
+	if ((term & 0x100) && ((r = memchr (p, 0x0A, len)) != NULL))
+		q = r ;
+	return q ;
+}
+
+// Read up to max bytes into dst, stopping after a terminator as specified
+// by GET$# TO term (-1 for none) which is read but not stored.  Returns the
+// number of bytes stored, with *peof set if the end-of-file was reached:
+int osbgets (void *chan, char *dst, int max, int term, int *peof)
+{
+	int n = 0 ;
+	*peof = 0 ;
+	if (mapped (chan))
+	    {
+		size_t i = (size_t) chan ;
+		unsigned char *p = fmap[i].base + fmap[i].ptr, *q ;
+		long long avail = fmap[i].size - fmap[i].ptr ;
+		if (avail <= 0)
+		    {
+			*peof = 1 ;
+			return 0 ;
+		    }
+		n = (avail > max) ? max : avail ;
+		q = termscan (p, n, term) ;
+		if (q)
+			n = q - p ;
+		memcpy (dst, p, n) ;
+		fmap[i].ptr += n + (q != NULL) ;
+		return n ;
+	    }
+	if ((chan > (void *)MAX_PORTS) && (chan <= (void *)(MAX_PORTS+MAX_FILES)))
+	    {
+		int index = (size_t) chan - MAX_PORTS - 1 ;
+		unsigned char *buffer = (unsigned char *) filbuf[0] + index * 0x100 ;
+		FCB *pfcb = &fcbtab[index] ;
+		while (n < max)
+		    {
+			unsigned char *p, *q ;
+			int len ;
+			if (pfcb->p == pfcb->o)
+			    {
+				FILE *handle = (FILE *) filbuf[(size_t) chan] ;
+				if (writeb (handle, buffer, pfcb))
+					error (189, "Couldn't write to file") ;
+				readb (handle, buffer, pfcb) ;
+				if ((pfcb->f & 1) == 0)
+				    {
+					*peof = 1 ;
+					return n ;
+				    }
+			    }
+			len = ((pfcb->o - pfcb->p - 1) & 0xFF) + 1 ;
+			if (len > 256 - pfcb->p)
+				len = 256 - pfcb->p ;
+			if (len > max - n)
+				len = max - n ;
+			p = buffer + pfcb->p ;
+			q = termscan (p, len, term) ;
+			if (q)
+				len = q - p ;
+			memcpy (dst + n, p, len) ;
+			n += len ;
+			pfcb->p += len + (q != NULL) ;
+			if (q)
+				break ;
+		    }
+		return n ;
+	    }
+	while (n < max)
+	    {
+		unsigned char al = osbget (chan, peof) ;
+		if (*peof)
+			break ;
+		if ((term >= 0) && ((al == (term & 0xFF)) ||
+				((al == 0x0D) && (term & 0x8100)) ||
+				((al == 0x0A) && (term & 0x100))))
+			break ;
+		dst[n++] = al ;
+	    }
+	return n ;
+}
+
 // Write a byte:
 void osbput (void *chan, unsigned char byte)
 {
@@ -1364,6 +1515,8 @@ void osbput (void *chan, unsigned char byte)
 #endif
 		return ;
 	    }
+	if (mapped (chan))
+		error (189, "Couldn't write to file") ;
 	if ((chan > (void *)MAX_PORTS) && (chan <= (void *)(MAX_PORTS+MAX_FILES)))
 	    {
 		int index = (size_t) chan - MAX_PORTS - 1 ;
@@ -1388,6 +1541,8 @@ void osbput (void *chan, unsigned char byte)
 // Get file pointer:
 long long getptr (void *chan)
 {
+	if (mapped (chan))
+		return fmap[(size_t) chan].ptr ;
 	myfseek (lookup (chan), 0, SEEK_CUR) ;
 	long long ptr = myftell (lookup (chan)) ;
 	if (ptr == -1)
@@ -1410,6 +1565,13 @@ long long getptr (void *chan)
 // Set file pointer:
 void setptr (void *chan, long long ptr)
 {
+	if (mapped (chan))
+	    {
+		if (ptr < 0)
+			error (189, "Couldn't set file pointer") ;
+		fmap[(size_t) chan].ptr = ptr ;
+		return ;
+	    }
 	if ((chan > (void *)MAX_PORTS) && (chan <= (void *)(MAX_PORTS+MAX_FILES)))
 	    {
 		int index = (size_t) chan - MAX_PORTS - 1 ;
@@ -1442,6 +1604,8 @@ long long getext (void *chan)
 		return 0 ;
 #endif
 	    }
+	if (mapped (chan))
+		return MAX(fmap[(size_t) chan].size, fmap[(size_t) chan].ptr) ;
 	long long newptr = getptr (chan) ;
 	myfseek (file, 0, SEEK_CUR) ;
 	long long ptr = myftell (file) ;
@@ -1458,15 +1622,120 @@ long long getext (void *chan)
 // Get EOF status:
 long long geteof (void *chan)
 {
+	if (mapped (chan))
+		return -(fmap[(size_t) chan].ptr >= fmap[(size_t) chan].size) ;
 	if ((chan > (void *)MAX_PORTS) && (chan <= (void *)(MAX_PORTS+MAX_FILES)))
 	    {
 		FCB *pfcb = &fcbtab[(size_t) chan - MAX_PORTS - 1] ;
-		if ((pfcb->p != 0) && (pfcb->o == 0) && ((pfcb->f) & 1))
+		if ((pfcb->f & 1) && (pfcb->o ? (pfcb->p < pfcb->o) : (pfcb->p != 0)))
+			return 0 ; // unread data in buffer
+		if ((pfcb->p == pfcb->o) && (pfcb->f >= 0))
+		    {
+			// Peek at the next byte rather than seek to the end:
+			FILE *handle = (FILE *) filbuf[(size_t) chan] ;
+			int c ;
+			if ((c = getc (handle)) == EOF)
+				return -1 ;
+			ungetc (c, handle) ;
 			return 0 ;
+		    }
 	    }
 	return -(getptr (chan) >= getext (chan)) ;
 }
 
+// Transfer a block of bytes to or from a channel (OSGBPB reason codes 1 and 2
+// write, 3 and 4 read, 1 and 3 starting at the supplied PTR), bypassing the
+// 256-byte channel buffer. Accessible from BASIC as SYS "BBC_OSGBPB",
+// reason%, chan%, addr, count% [, ptr%] TO done% where addr is a DIMmed block
+// or PTR(a$); returns the number of bytes actually transferred:
+long long osgbpb (int reason, void *chan, unsigned char *data, long long count, long long ptr)
+{
+	long long done = 0 ;
+	if ((reason < 1) || (reason > 4) || (count < 0))
+		error (31, NULL) ; // 'Incorrect arguments'
+	if (chan <= (void *)MAX_PORTS)
+	    {
+		if (reason <= 2)
+			while (done < count)
+				osbput (chan, data[done++]) ;
+		else
+			while (done < count)
+				data[done++] = osbget (chan, NULL) ;
+		return done ;
+	    }
+	if ((reason == 1) || (reason == 3))
+		setptr (chan, ptr) ;
+	if (mapped (chan))
+	    {
+		size_t n = (size_t) chan ;
+		if ((reason >= 3) && (fmap[n].ptr < fmap[n].size))
+		    {
+			done = fmap[n].size - fmap[n].ptr ;
+			if (done > count)
+				done = count ;
+			memcpy (data, fmap[n].base + fmap[n].ptr, done) ;
+			fmap[n].ptr += done ;
+		    }
+		return done ; // writes fail, as on an OPENIN channel
+	    }
+	else if (chan <= (void *)(MAX_PORTS + MAX_FILES))
+		setptr (chan, getptr (chan)) ; // flush and empty the channel buffer
+	FILE *file = lookup (chan) ;
+#ifdef _WIN32
+	long long pos = myftell (file) ;
+#endif
+	if (reason <= 2)
+		done = fwrite (data, 1, count, file) ;
+	else
+		done = fread (data, 1, count, file) ;
+#ifdef _WIN32
+	myfseek (file, pos + done, SEEK_SET) ;
+#endif
+	return done ;
+}
+
+// Map a channel opened by OPENIN into memory, after which BGET#, PTR#,
+// EXT#, EOF# and OSGBPB reads are served from the mapping with no copying
+// through the channel buffer.  Accessible from BASIC as SYS "BBC_MapFile",
+// chan% TO base%% so that the file can be accessed using indirection;
+// returns zero if the channel can't be mapped (it is then unchanged):
+void *mapfile (void *chan)
+{
+	size_t n = (size_t) chan ;
+	long long ptr, size ;
+	FILE *file ;
+	void *base ;
+
+	if ((n <= MAX_PORTS) || (n > MAX_PORTS + MAX_FILES) || !inonly[n] || !filbuf[n])
+		return NULL ;
+	if (fmap[n].base)
+		return fmap[n].base ;
+	file = lookup (chan) ;
+	ptr = getptr (chan) ;
+	size = getext (chan) ;
+	if ((size <= 0) || (size != (long long)(size_t) size))
+		return NULL ;
+#ifdef _WIN32
+	HANDLE hmap = CreateFileMapping ((HANDLE) _get_osfhandle (fileno (file)),
+					 NULL, PAGE_READONLY, 0, 0, NULL) ;
+	if (hmap == NULL)
+		return NULL ;
+	base = MapViewOfFile (hmap, FILE_MAP_READ, 0, 0, 0) ;
+	CloseHandle (hmap) ; // the view keeps the mapping open
+	if (base == NULL)
+		return NULL ;
+#else
+	base = mmap (NULL, size, PROT_READ, MAP_SHARED, fileno (file), 0) ;
+	if (base == MAP_FAILED)
+		return NULL ;
+#endif
+	fmap[n].base = base ;
+	fmap[n].size = size ;
+	fmap[n].ptr = ptr ;
+	*(int *)&fcbtab[n - MAX_PORTS - 1] = 0 ;
+	return base ;
+}
+
 // Close file (if chan = 0 all open files closed and errors ignored):
 void osshut (void *chan)
 {
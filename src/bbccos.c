@@ -38,7 +38,7 @@ typedef dispatch_source_t timer_t ;
 #endif
 
 #undef MAX_PATH
-#define NCMDS 42	// number of OSCLI commands
+#define NCMDS 44	// number of OSCLI commands
 #define POWR2 32	// largest power-of-2 less than NCMDS
 #ifdef PICO
 #define COPYBUFLEN 512	// length of buffer used for *COPY command
@@ -65,9 +65,13 @@ void StopTimer (timer_t) ;
 void SystemIO (int) ;
 int stdin_handler (int*, int*) ;
 int getkey (unsigned char *) ;
+void profile (int) ;
+int profsave (const char *) ;
 
 // Global variables:
 extern timer_t UserTimerID ;
+extern unsigned char fastxq ;	// *TURBO mode (per-site variable cache)
+extern int filbufsz ;		// File channel buffer size in KB (*FX 254)
 
 static short modetab[NUMMODES][5] =
 {
@@ -88,17 +92,17 @@ static char *cmds[NCMDS] = {
 		"bye", "cd", "chdir", "copy", "del", "delete", "dir",
 		"dump", "era", "erase", "esc", "exec", "float", "fx",
 		"help", "hex", "input", "key", "list", "load", "lock", "lowercase",
-		"md", "mkdir", "output", "quit", "rd", "refresh",
+		"md", "mkdir", "output", "profile", "quit", "rd", "refresh",
 		"ren", "rename", "rmdir", "run", "save", "spool", "spoolon",
-		"stereo", "tempo", "timer", "tv", "type", "unlock", "voice" } ;
+		"stereo", "tempo", "timer", "turbo", "tv", "type", "unlock", "voice" } ;
 
 enum {
 		BYE, CD, CHDIR, COPY, DEL, DELETE, DIRCMD,
 		DUMP, ERA, ERASE, ESC, EXEC, FLOAT, FX,
 		HELP, HEX, INPUT, KEY, LIST, LOAD, LOCK, LOWERCASE,
-		MD, MKDIR, OUTPUT, QUIT, RD, REFRESH,
+		MD, MKDIR, OUTPUT, PROFILE, QUIT, RD, REFRESH,
 		REN, RENAME, RMDIR, RUN, SAVE, SPOOL, SPOOLON,
-		STEREO, TEMPO, TIMER, TV, TYPE, UNLOCK, VOICE } ;
+		STEREO, TEMPO, TIMER, TURBO, TV, TYPE, UNLOCK, VOICE } ;
 
 // Change to a new screen mode:
 static void newmode (short wx, short wy, short cx, short cy, short nc, signed char bc) 
@@ -208,16 +212,20 @@ void xeqvdu (int code, int data1, int data2)
 	int vdu = code >> 8 ;
 	static int col = 0, row = 0 ;
 	static int rhs = 999 ;
+	static signed char tty = -1 ; // console is a terminal (tested once)
 
+	if (tty < 0)
 #ifdef _WIN32
-	if (!_isatty (_fileno (stdin)) || !_isatty (_fileno (stdout)))
+		tty = _isatty (_fileno (stdin)) && _isatty (_fileno (stdout)) ;
 #else
 # ifdef PICO
-    if (0)
+		tty = 1 ;
 # else
-	if (!isatty (STDIN_FILENO) || !isatty (STDOUT_FILENO))
+		tty = isatty (STDIN_FILENO) && isatty (STDOUT_FILENO) ;
 # endif
 #endif
+
+	if (!tty)
 	    {
 		printf ("%c", vdu) ;
 		return ;
@@ -418,7 +426,8 @@ void xeqvdu (int code, int data1, int data2)
 					col++ ;
 			    }
 	    }
-	fflush (stdout) ;
+	if (vdu == 10)
+		fflush (stdout) ; // else flushed on input or timer tick
 }
 
 // Parse a filespec, return pointer to terminator.
@@ -821,6 +830,12 @@ void oscli (char *cmd)
 					quiet () ;
 				kbdqr = kbdqw ;
 			    }
+			else if (n == 254)
+			    {
+				if ((b < 0) || (b > 0x10000))
+					error (254, "Bad command") ;
+				filbufsz = b ;
+			    }
 			else if (n == 21)
 			    {
 				if (b == 0)
@@ -982,6 +997,7 @@ void oscli (char *cmd)
 			if (*q == ';')
 				*q = '&' ;
 			SystemIO (1) ;
+			fflush (stdout) ;
 			if (0 != system (path))
 			    {
 				SystemIO (0) ;
@@ -1052,6 +1068,10 @@ void oscli (char *cmd)
 			UserTimerID = StartTimer (n) ; 
 			return ;
 
+		case TURBO:
+			fastxq = onoff (p) ;
+			return ;
+
 		case TV:
 			return ;		// ignored
 
@@ -1096,6 +1116,20 @@ void oscli (char *cmd)
 			optval = (optval & 0xF0) | (n & 0x0F) ;
 			return ;
 
+		case PROFILE:			// *PROFILE ON|OFF|filename
+			if (((*p & 0x5F) == 'O') && ((*(p + 1) & 0x5F) == 'N') && (*(p + 2) <= ' '))
+				profile (1) ;
+			else if (((*p & 0x5F) == 'O') && ((*(p + 1) & 0x5F) == 'F') &&
+				 ((*(p + 2) & 0x5F) == 'F') && (*(p + 3) <= ' '))
+				profile (0) ;
+			else
+			    {
+				setup (path, p, ".txt", ' ', NULL) ;
+				if ((*path == 0) || !profsave (path))
+					error (189, "Couldn't create file") ;
+			    }
+			return ;
+
 		case DUMP:
 			p = setup (path, p, ".bbc", ' ', NULL) ;
 			srcfile = fopen (path, "rb") ;
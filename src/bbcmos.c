@@ -47,6 +47,7 @@ void *dlsym (void *, const char *) ;
 void error (int, const char *) ;
 void text (const char *) ;	// Output NUL-terminated string
 void crlf (void) ;		// Output a newline
+void *sysint (char *) ;		// Get address of interpreter function
 
 // Declared in bbeval.c:
 unsigned int rnd (void) ;	// Return a pseudo-random number
@@ -911,8 +912,8 @@ static int BBC_PushEvent(SDL_Event* event)
 	return ret ;
 }
 
-// Push event onto queue:
-void pushev (int code, void *data1, void *data2)
+// Push event onto SDL queue:
+static void pushsdl (int code, void *data1, void *data2)
 {
 	SDL_Event event ;
 
@@ -931,6 +932,39 @@ void pushev (int code, void *data1, void *data2)
 		SDL_Delay (1) ;
 }
 
+// Append a VDU command to the ring drained by the GUI thread, pushing an
+// EVT_VDU event to wake it only if one isn't already outstanding:
+static void pushvdu (int code, void *data1, void *data2)
+{
+	unsigned int head = SDL_AtomicGet (&vduhead) ;
+	LPVDUCMD cmd = vduring + (head & (VDURING - 1)) ;
+
+	while ((head - (unsigned int) SDL_AtomicGet (&vdutail)) >= VDURING)
+	    {
+		if (flags & KILL)
+			return ;
+		SDL_Delay (1) ;
+	    }
+
+	cmd->code = code ;
+	cmd->data1 = data1 ;
+	cmd->data2 = data2 ;
+	SDL_AtomicSet (&vduhead, head + 1) ; // publish (full memory barrier)
+
+	if (SDL_AtomicCAS (&vduwake, 0, 1))
+		pushsdl (EVT_VDU, NULL, NULL) ;
+}
+
+// Push event onto queue.  VDU commands go via the ring; the GUI thread
+// drains it before handling any other event, so ordering is preserved:
+void pushev (int code, void *data1, void *data2)
+{
+	if ((code == EVT_VDU) || ((code >= 0x0100) && (code <= 0x1FFF)))
+		pushvdu (code, data1, data2) ;
+	else
+		pushsdl (code, data1, data2) ;
+}
+
 static int BBC_RWclose (struct SDL_RWops* context)
 {
 	int ret = SDL_RWclose (context) ;
@@ -1028,28 +1062,39 @@ int vtint (int x, int y)
 	return waitev () ;
 }
 
-// Get nearest palette index:
-int vpoint (int x, int y)
+// Palette index lookup cache, discarded whenever the palette changes:
+#define PNTBITS 10
+static unsigned int palcopy[256] ;
+static int palsize ;
+static int pntkey[1 << PNTBITS] ;		// RGB + 1 (0 = unused)
+static unsigned char pntidx[1 << PNTBITS] ;
+
+// Find the nearest palette index to an RGB colour:
+static int nearest (int rgb)
 {
-	unsigned char rgb[3] ;
 	unsigned int best = 0x7FFFFFFF ;
-	int i, n = -1 ;
-	pushev (EVT_TINT, (void *)(intptr_t)x, (void *)(intptr_t)y) ;
-	i = waitev () ;
-	if (i < 0)
-		return i ;
-	rgb[0] = i & 0xFF ;
-	rgb[1] = i >> 8 ;
-	rgb[2] = i >> 16 ;
-	for (i = 0; i <= colmsk; i++)
+	unsigned int slot = ((unsigned int) rgb * 2654435761U) >> (32 - PNTBITS) ;
+	int i, n = 0, size = colmsk + 1 ;
+	unsigned char r = rgb, g = rgb >> 8, b = rgb >> 16 ;
+
+	if ((size != palsize) || memcmp (palcopy, palette, size * sizeof(int)))
+	    {
+		memcpy (palcopy, palette, size * sizeof(int)) ;
+		memset (pntkey, 0, sizeof(pntkey)) ;
+		palsize = size ;
+	    }
+	else if (pntkey[slot] == rgb + 1)
+		return pntidx[slot] ;
+
+	for (i = 0; i < size; i++)
 	    {
 		unsigned int sqr ;
 		int dif ;
-		dif = rgb[0] - (palette[i] & 0xFF) ;
+		dif = r - (palcopy[i] & 0xFF) ;
 		sqr = dif * dif ;
-		dif = rgb[1] - ((palette[i] >> 8) & 0xFF) ;
+		dif = g - ((palcopy[i] >> 8) & 0xFF) ;
 		sqr += dif * dif ;
-		dif = rgb[2] - ((palette[i] >> 16) & 0xFF) ;
+		dif = b - ((palcopy[i] >> 16) & 0xFF) ;
 		sqr += dif * dif ;
 		if (sqr < best)
 		    {
@@ -1057,9 +1102,57 @@ int vpoint (int x, int y)
 			n = i ;
 		    }
 	    }
+	pntkey[slot] = rgb + 1 ;
+	pntidx[slot] = n ;
 	return n ;
 }
 
+// Get nearest palette index:
+int vpoint (int x, int y)
+{
+	int rgb ;
+	pushev (EVT_TINT, (void *)(intptr_t)x, (void *)(intptr_t)y) ;
+	rgb = waitev () ;
+	if (rgb < 0)
+		return rgb ;
+	return nearest (rgb) ;
+}
+
+// Read a w x h pixel rectangle, whose bottom-left corner is at graphics
+// coordinates x,y, into buf as RGB colours (as TINT) or, if pal is non-zero,
+// palette indices (as POINT), bottom row first.  Returns number of pixels:
+int readpix (int x, int y, int w, int h, int *buf, int pal)
+{
+	SDL_Rect rect ;
+	unsigned char *tmp, *p ;
+	int i, j, pitch = (w * 3 + 3) & -4 ;
+
+	if ((w <= 0) || (h <= 0) || (buf == NULL))
+		return 0 ;
+	tmp = malloc (pitch * h) ;
+	if (tmp == NULL)
+		error (255, "Out of memory") ;
+
+	rect.x = x ;
+	rect.y = y ;
+	rect.w = w ;
+	rect.h = h ;
+	pushev (EVT_PIXELS, &rect, tmp) ;
+	waitev () ;
+
+	for (j = 0; j < h; j++)
+	    {
+		p = tmp + j * pitch ;
+		for (i = 0; i < w; i++, p += 3)
+		    {
+			int rgb = (p[0] << 16) | (p[1] << 8) | p[2] ; // BGR24
+			*buf++ = pal ? nearest (rgb) : rgb ;
+		    }
+	    }
+	free (tmp) ;
+	return w * h ;
+}
+
 int vgetc (int x, int y)
 {
 	int eax, ebx, ecx ;
@@ -1635,8 +1728,8 @@ void *sysadr (char *name)
 {
 // On Android it's important to use 'SDL_GL_GetProcAddress' in preference
 // because 'dlsym' may return the wrong address for OpenGLES functions.
-	void *addr = NULL ;
-	if (useGPA)
+	void *addr = sysint (name) ;
+	if ((addr == NULL) && useGPA)
 		addr = SDL_GL_GetProcAddress (name) ;
 	if (addr != NULL)
 		return addr ; 
@@ -2143,6 +2236,10 @@ void ossave (char *p, void *addr, int len)
 		error (189, SDL_GetError ()) ;
 }
 
+// Per-channel stdio buffers, sized in KB by *FX 254 (0 = system default):
+int filbufsz = 64 ;
+static char *iobuf[MAX_PORTS + MAX_FILES + 1] ;
+
 // Open a file:
 void *osopen (int type, char *p)
 {
@@ -2180,7 +2277,14 @@ void *osopen (int type, char *p)
 		    {
 			filbuf[chan] = file ;
 			if (chan > MAX_PORTS)
+			    {
 				*(int *)&fcbtab[chan - MAX_PORTS - 1] = 0 ;
+#ifndef __WINDOWS__
+				if (filbufsz && (file->type == SDL_RWOPS_STDFILE) &&
+					((iobuf[chan] = malloc (filbufsz << 10)) != NULL))
+					setvbuf (file->hidden.stdio.fp, iobuf[chan], _IOFBF, filbufsz << 10) ;
+#endif
+			    }
 			return (void *)(size_t)chan ;
 		    }
 	    }
@@ -2226,6 +2330,13 @@ static int writeb (SDL_RWops *context, unsigned char *buffer, FCB *pfcb)
 	return (amount == 0) ;
 }
 
+// Memory-mapping a channel isn't supported by SDL_RWops, so return zero
+// (the channel remains usable in the normal way):
+void *mapfile (void *chan)
+{
+	return NULL ;
+}
+
 // Close a single file:
 static int closeb (void *chan)
 {
@@ -2241,7 +2352,11 @@ static int closeb (void *chan)
 	    }
 	result = BBC_RWclose (lookup (chan)) ;
 	if ((chan >= (void *)1) && (chan <= (void *)(MAX_PORTS + MAX_FILES)))
+	    {
 		filbuf[(size_t)chan] = 0 ;
+		free (iobuf[(size_t)chan]) ;
+		iobuf[(size_t)chan] = NULL ;
+	    }
 	return result ;
 }
 
@@ -2286,6 +2401,84 @@ unsigned char osbget (void *chan, int *peof)
 	return byte ;
 }
 
+// Find the first terminator, as specified by GET$# TO term, in a block:
+static unsigned char *termscan (unsigned char *p, int len, int term)
+{
+	unsigned char *q, *r ;
+	if (term < 0)
+		return NULL ;
+	q = memchr (p, term & 0xFF, len) ;
+	if (q)
+		len = q - p ;
+	if ((term & 0x8100) && ((r = memchr (p, 0x0D, len)) != NULL))
+	    {
+		q = r ;
+		len = q - p ;
+	    }
+	if ((term & 0x100) && ((r = memchr (p, 0x0A, len)) != NULL))
+		q = r ;
+	return q ;
+}
+
+// Read up to max bytes into dst, stopping after a terminator as specified
+// by GET$# TO term (-1 for none) which is read but not stored.  Returns the
+// number of bytes stored, with *peof set if the end-of-file was reached:
+int osbgets (void *chan, char *dst, int max, int term, int *peof)
+{
+	int n = 0 ;
+	*peof = 0 ;
+	if ((chan > (void *)MAX_PORTS) && (chan <= (void *)(MAX_PORTS+MAX_FILES)))
+	    {
+		int index = (size_t) chan - MAX_PORTS - 1 ;
+		unsigned char *buffer = (unsigned char *) filbuf[0] + index * 0x100 ;
+		FCB *pfcb = &fcbtab[index] ;
+		while (n < max)
+		    {
+			unsigned char *p, *q ;
+			int len ;
+			if (pfcb->p == pfcb->o)
+			    {
+				SDL_RWops *handle = (SDL_RWops *) filbuf[(size_t) chan] ;
+				if (writeb (handle, buffer, pfcb))
+					error (189, SDL_GetError ()) ;
+				readb (handle, buffer, pfcb) ;
+				if ((pfcb->f & 1) == 0)
+				    {
+					*peof = 1 ;
+					return n ;
+				    }
+			    }
+			len = ((pfcb->o - pfcb->p - 1) & 0xFF) + 1 ;
+			if (len > 256 - pfcb->p)
+				len = 256 - pfcb->p ;
+			if (len > max - n)
+				len = max - n ;
+			p = buffer + pfcb->p ;
+			q = termscan (p, len, term) ;
+			if (q)
+				len = q - p ;
+			memcpy (dst + n, p, len) ;
+			n += len ;
+			pfcb->p += len + (q != NULL) ;
+			if (q)
+				break ;
+		    }
+		return n ;
+	    }
+	while (n < max)
+	    {
+		unsigned char al = osbget (chan, peof) ;
+		if (*peof)
+			break ;
+		if ((term >= 0) && ((al == (term & 0xFF)) ||
+				((al == 0x0D) && (term & 0x8100)) ||
+				((al == 0x0A) && (term & 0x100))))
+			break ;
+		dst[n++] = al ;
+	    }
+	return n ;
+}
+
 // Write a byte:
 void osbput (void *chan, unsigned char byte)
 {
@@ -2393,12 +2586,54 @@ long long geteof (void *chan)
 	if ((chan > (void *)MAX_PORTS) && (chan <= (void *)(MAX_PORTS+MAX_FILES)))
 	    {
 		FCB *pfcb = &fcbtab[(size_t) chan - MAX_PORTS - 1] ;
-		if ((pfcb->p != 0) && (pfcb->o == 0) && ((pfcb->f) & 1))
+		if ((pfcb->f & 1) && (pfcb->o ? (pfcb->p < pfcb->o) : (pfcb->p != 0)))
+			return 0 ; // unread data in buffer
+		if ((pfcb->p == pfcb->o) && (pfcb->f >= 0))
+		    {
+			// Peek at the next byte rather than seek to the end:
+			SDL_RWops *handle = (SDL_RWops *) filbuf[(size_t) chan] ;
+			unsigned char c ;
+			if (SDL_RWread (handle, &c, 1, 1) == 0)
+				return -1 ;
+			SDL_RWseek (handle, -1, RW_SEEK_CUR) ;
 			return 0 ;
+		    }
 	    }
 	return -(getptr (chan) >= getext (chan)) ;
 }
 
+// Transfer a block of bytes to or from a channel (OSGBPB reason codes 1 and 2
+// write, 3 and 4 read, 1 and 3 starting at the supplied PTR), bypassing the
+// 256-byte channel buffer. Accessible from BASIC as SYS "BBC_OSGBPB",
+// reason%, chan%, addr, count% [, ptr%] TO done% where addr is a DIMmed block
+// or PTR(a$); returns the number of bytes actually transferred:
+long long osgbpb (int reason, void *chan, unsigned char *data, long long count, long long ptr)
+{
+	long long done = 0 ;
+	if ((reason < 1) || (reason > 4) || (count < 0))
+		error (31, NULL) ; // 'Incorrect arguments'
+	if (chan <= (void *)MAX_PORTS)
+	    {
+		if (reason <= 2)
+			while (done < count)
+				osbput (chan, data[done++]) ;
+		else
+			while (done < count)
+				data[done++] = osbget (chan, NULL) ;
+		return done ;
+	    }
+	if ((reason == 1) || (reason == 3))
+		setptr (chan, ptr) ;
+	else if (chan <= (void *)(MAX_PORTS + MAX_FILES))
+		setptr (chan, getptr (chan)) ; // flush and empty the channel buffer
+	SDL_RWops *file = lookup (chan) ;
+	if (reason <= 2)
+		done = SDL_RWwrite (file, data, 1, count) ;
+	else
+		done = SDL_RWread (file, data, 1, count) ;
+	return done ;
+}
+
 // Close file (if chan = 0 all open files closed and errors ignored):
 void osshut (void *chan)
 {
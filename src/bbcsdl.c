@@ -119,6 +119,8 @@ long long apicall_ (void *, void *) ;
 // Routines in BBCTTXT:
 
 void flip7 (void) ;
+void glyphflush (void) ;
+void glyphreset (void) ;
 
 // Routines in SDL2_gfxPrimitives:
 
@@ -138,11 +140,13 @@ char *szLibrary ;
 char *szUserDir ;
 char *szTempDir ;
 char *szCmdLine ;
-SDL_Texture *TTFcache[65536] = {NULL} ; // cache for character textures
+SDL_Texture *TTFcache[65536] = {NULL} ; // @cache%, no longer used (see glyphadd)
 unsigned int palette[256] ;
 size_t iResult = 0 ;
 int bChanged = 0 ;
 int nUserEv = 0 ;
+VDUCMD vduring[VDURING] ;
+SDL_atomic_t vduhead, vdutail, vduwake ;
 int OSKtime = 6 ;
 SDL_Rect ClipRect ;
 SDL_Rect DestRect ;
@@ -173,6 +177,7 @@ void (*glDisableBBC) (int) ;
 void (*glTexParameteriBBC) (int, int, int) ;
 #endif
 void (*SDL_RenderFlushBBC) (SDL_Renderer*) ;
+int (*SDL_RenderGeometryBBC) (SDL_Renderer*, SDL_Texture*, const SDL_Vertex*, int, const int*, int) ;
 void SetErrorBBC (void) { SDL_SetError ("OS error %i", errno) ; }
 
 static SDL_Window * window ;
@@ -525,6 +530,28 @@ static int myEventFilter(void* userdata, SDL_Event* pev)
 	return 0 ;
 }
 
+// Execute the VDU commands queued by the interpreter thread (stopping if
+// paged mode pauses output, unless 'all') and return the number executed:
+static int drainvdu (int all)
+{
+	unsigned int tail = SDL_AtomicGet (&vdutail) ;
+	unsigned int head = SDL_AtomicGet (&vduhead) ;
+	int n = 0 ;
+
+	while ((tail != head) && (all || ((scroln <= 0) && (bBackground == 0))))
+	    {
+		LPVDUCMD cmd = vduring + (tail & (VDURING - 1)) ;
+		if (cmd->code == EVT_VDU)
+			vduchr_ (cmd->data1) ;
+		else
+			xeqvdu_ (cmd->data2, cmd->data1, cmd->code) ;
+		SDL_AtomicSet (&vdutail, ++tail) ; // release the slot
+		n++ ;
+	    }
+	glyphflush () ; // draw any characters still queued
+	return n ;
+}
+
 static int maintick (void) ;
 
 void mainloop (void)
@@ -800,8 +827,10 @@ szLoadDir = szLibrary - 0x100 ;
 
 #if defined __IPHONEOS__ || defined __EMSCRIPTEN__
 SDL_RenderFlushBBC = SDL_GL_GetProcAddress ("SDL_RenderFlush") ;
+SDL_RenderGeometryBBC = SDL_GL_GetProcAddress ("SDL_RenderGeometry") ;
 #else
 SDL_RenderFlushBBC = dlsym ((void *) -1, "SDL_RenderFlush") ;
+SDL_RenderGeometryBBC = dlsym ((void *) -1, "SDL_RenderGeometry") ;
 #endif
 
 glTexParameteriBBC = SDL_GL_GetProcAddress ("glTexParameteri") ;
@@ -1196,6 +1225,9 @@ static int maintick (void)
 			scroln = 0 ;        // exit paged mode
 	    }
 
+	if (drainvdu (0))
+		lastusrev = SDL_GetTicks() ;
+
 	if (bBackground || (scroln > 0) ?
 		BBC_PeepEvents(&ev, 1, SDL_GETEVENT, 0, SDL_USEREVENT-1) :
 		BBC_PeepEvents(&ev, 1, SDL_GETEVENT, 0, SDL_LASTEVENT))
@@ -1221,20 +1253,14 @@ static int maintick (void)
 		case SDL_USEREVENT:
 			SDL_AtomicDecRef ((SDL_atomic_t*) &nUserEv) ;
 
-			if ((ev.user.code >= 0x0100) && (ev.user.code <= 0x1FFF))
-			{
-				xeqvdu_ (ev.user.data2, ev.user.data1, ev.user.code) ;
-				if ((ev.user.code >> 8) == 25)
-					lastusrev = SDL_GetTicks() ;
-				break ;
-			}
-			else switch (ev.user.code)
-			{
-				case EVT_VDU :
-				vduchr_ (ev.user.data1) ;
+			// Any VDU commands queued before this event must be executed first:
+			if (ev.user.code == EVT_VDU)
+				SDL_AtomicSet (&vduwake, 0) ;
+			if (drainvdu (ev.user.code != EVT_VDU))
 				lastusrev = SDL_GetTicks() ;
-				break ;
 
+			switch (ev.user.code)
+			{
 				case EVT_COPYKEY :
 				iResult = copkey_ (ev.user.data1, ev.user.data2) ;
 				SDL_SemPost (Sema4) ;
@@ -1390,7 +1416,8 @@ static int maintick (void)
 				break ;
 
 				case WMU_TIMER :
-				if (nUserEv <= 0)
+				if ((nUserEv <= 0) &&
+				    (SDL_AtomicGet (&vduhead) == SDL_AtomicGet (&vdutail)))
 					flip7 () ;
 				if (timtrp)
 				{
@@ -1688,18 +1715,13 @@ static int maintick (void)
 		case SDL_RENDER_DEVICE_RESET:
 			{
 				int w, h ;
-				SDL_Texture **p, *t = SDL_GetRenderTarget (renderer) ;
+				SDL_Texture *t = SDL_GetRenderTarget (renderer) ;
 				SDL_GL_GetDrawableSize (window, &w, &h) ;
 				if (t != NULL) SDL_DestroyTexture (t) ;
 				SDL_SetRenderTarget(renderer, SDL_CreateTexture(renderer, 
 					SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_TARGET,
 					MAX(MAX(w,h),XSCREEN), MAX(MAX(w,h),YSCREEN))) ;
-				for (p = TTFcache; p < TTFcache + 65536; p++)
-					if (*p != NULL)
-					{
-						SDL_DestroyTexture (*p) ;
-						*p = NULL ;
-					}
+				glyphreset () ;
 				buttexture = MakeBackButton (renderer) ;
 			}
 			break ;
@@ -38,10 +38,14 @@ int thickArcColor(SDL_Renderer*, Sint16, Sint16, Sint16, Sint16, Sint16, Uint32,
 int thickCircleColor(SDL_Renderer*, Sint16, Sint16, Sint16, Uint32, Uint8) ;
 int thickLineColorStyle (SDL_Renderer*, Sint16, Sint16, Sint16, Sint16, Uint8, Uint32, int) ;
 int RedefineChar (SDL_Renderer*, char, unsigned char*, Uint32, Uint32) ;
+SDL_Texture *characterAtlas (SDL_Renderer*, char, SDL_Rect*, int*, int*) ;
+
+// Functions in this file:
+void glyphflush (void) ;
 
 // Functions in flood.c:
 void flood(unsigned int* pBitmap, int x, int y, int w, int h,
-		unsigned int fill_color, unsigned int target_color, int type) ;
+		unsigned int fill_color, unsigned int target_color, int type, int *box) ;
 
 // Functions in bbcsdl.c:
 #ifdef __WINDOWS__
@@ -54,10 +58,13 @@ extern void (*glLogicOpBBC) (int) ;
 extern void (*glDisableBBC) (int) ;
 #endif
 extern int (*SDL_RenderFlushBBC) (SDL_Renderer*) ;
+extern int (*SDL_RenderGeometryBBC) (SDL_Renderer*, SDL_Texture*, const SDL_Vertex*, int,
+				     const int*, int) ;
 
 // Functions in bbcttx.c:
 void page7 (void) ;
 void send7 (char, short *, short *, int) ;
+void dirty7 (short *) ;
 extern unsigned char frigo[], frign[] ;
 
 static char xscrol[] = {0, 2, 1, 3} ;
@@ -217,6 +224,7 @@ static int BBC_RenderSetClipRect (SDL_Renderer* renderer, SDL_Rect* rect)
 {
 	int w, h, result ;
 
+	glyphflush () ;
 	if ((rect == NULL) || (platform >= 0x02000400))
 		return SDL_RenderSetClipRect(renderer, rect) ;
 
@@ -234,6 +242,7 @@ static int BBC_RenderSetClipRect (SDL_Renderer* renderer, SDL_Rect* rect)
 int BBC_RenderReadPixels (SDL_Renderer* renderer, const SDL_Rect* rect,
                           Uint32 format, void* pixels, int pitch)
 {
+	glyphflush () ;
 #ifdef __EMSCRIPTEN__
 	return SDL_RenderReadPixels (renderer, rect, format, pixels, pitch) ;
 #else
@@ -366,6 +375,7 @@ static void blit (int dstx, int dsty, int srcx, int srcy, int w, int h, int bg)
 	SDL_Rect src = {srcx, srcy, w, h} ;
 	SDL_Texture *tex, *tex2, *target ;
 
+	glyphflush () ;
 	tex = SDL_CreateTexture (memhdc, SDL_PIXELFORMAT_ABGR8888,
                                  SDL_TEXTUREACCESS_TARGET, w, h) ;
 	target = SDL_GetRenderTarget (memhdc) ;
@@ -394,11 +404,18 @@ static void blit (int dstx, int dsty, int srcx, int srcy, int w, int h, int bg)
 	SDL_DestroyTexture (tex) ;
 }
 
-// Flood fill WHILE colour = specified target
-static void flooda (unsigned char col, unsigned char tar, int cx, int cy, int vl, int vr, int vt, int vb)
+// Scratch buffer and streaming texture, kept between fills and only
+// reallocated when a larger viewport is filled:
+static unsigned int *floodbuf ;
+static int floodlen ;
+static SDL_Texture *floodtex ;
+static int floodtw, floodth ;
+
+// Flood fill, uploading only the bounding box of the changed pixels:
+static void floodx (unsigned char col, unsigned char tar, int cx, int cy,
+		    int vl, int vr, int vt, int vb, int type)
 {
-	unsigned int *p ;
-	SDL_Texture *tex ;
+	int box[4] ;
 
 	SDL_Rect rect = {vl, vt, vr - vl, vb - vt} ;
 
@@ -406,38 +423,47 @@ static void flooda (unsigned char col, unsigned char tar, int cx, int cy, int vl
 	    (cx < vl) || (cx >= vr) || (cy < vt) || (cy >= vb))
 		return ;
 
-	p = (unsigned int*) malloc (rect.w * rect.h * 4) ;
-	BBC_RenderReadPixels (memhdc, &rect, SDL_PIXELFORMAT_ABGR8888, p, rect.w * 4) ;
-	flood(p, cx-rect.x, cy-rect.y, rect.w, rect.h, palette[(int)col], palette[(int)tar], 0) ;
-	tex = SDL_CreateTexture (memhdc, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STREAMING, 
-				rect.w, rect.h) ;
-	SDL_UpdateTexture (tex, NULL, p, rect.w * 4) ;
-	free (p) ;
-	SDL_RenderCopy (memhdc, tex, NULL, &rect) ;
-	SDL_DestroyTexture (tex) ;
+	if (rect.w * rect.h > floodlen)
+	    {
+		free (floodbuf) ;
+		floodbuf = (unsigned int*) malloc (rect.w * rect.h * 4) ;
+		floodlen = floodbuf ? rect.w * rect.h : 0 ;
+		if (floodbuf == NULL)
+			return ;
+	    }
+	if ((floodtex == NULL) || (rect.w > floodtw) || (rect.h > floodth))
+	    {
+		if (floodtex)
+			SDL_DestroyTexture (floodtex) ;
+		if (rect.w > floodtw) floodtw = rect.w ;
+		if (rect.h > floodth) floodth = rect.h ;
+		floodtex = SDL_CreateTexture (memhdc, SDL_PIXELFORMAT_ABGR8888,
+				SDL_TEXTUREACCESS_STREAMING, floodtw, floodth) ;
+		if (floodtex == NULL)
+			return ;
+	    }
+
+	BBC_RenderReadPixels (memhdc, &rect, SDL_PIXELFORMAT_ABGR8888, floodbuf, rect.w * 4) ;
+	flood(floodbuf, cx-rect.x, cy-rect.y, rect.w, rect.h, palette[(int)col], palette[(int)tar], type, box) ;
+	if ((box[2] < box[0]) || (box[3] < box[1]))
+		return ; // nothing filled
+
+	SDL_Rect src = {0, 0, box[2] - box[0] + 1, box[3] - box[1] + 1} ;
+	SDL_Rect dst = {rect.x + box[0], rect.y + box[1], src.w, src.h} ;
+	SDL_UpdateTexture (floodtex, &src, floodbuf + box[1] * rect.w + box[0], rect.w * 4) ;
+	SDL_RenderCopy (memhdc, floodtex, &src, &dst) ;
+}
+
+// Flood fill WHILE colour = specified target
+static void flooda (unsigned char col, unsigned char tar, int cx, int cy, int vl, int vr, int vt, int vb)
+{
+	floodx (col, tar, cx, cy, vl, vr, vt, vb, 0) ;
 }
 
 // Flood fill UNTIL colour = specified target
 static void floodb (unsigned char col, unsigned char tar, int cx, int cy, int vl, int vr, int vt, int vb)
 {
-	unsigned int *p ;
-	SDL_Texture *tex ;
-
-	SDL_Rect rect = {vl, vt, vr - vl, vb - vt} ;
-
-	if ((rect.w <= 0) || (rect.h <= 0) ||
-	    (cx < vl) || (cx >= vr) || (cy < vt) || (cy >= vb))
-		return ;
-
-	p = (unsigned int*) malloc (rect.w * rect.h * 4) ;
-	BBC_RenderReadPixels (memhdc, &rect, SDL_PIXELFORMAT_ABGR8888, p, rect.w * 4) ;
-	flood(p, cx-rect.x, cy-rect.y, rect.w, rect.h, palette[(int)col], palette[(int)tar], 1) ;
-	tex = SDL_CreateTexture (memhdc, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STREAMING, 
-				rect.w, rect.h) ;
-	SDL_UpdateTexture (tex, NULL, p, rect.w * 4) ;
-	free (p) ;
-	SDL_RenderCopy (memhdc, tex, NULL, &rect) ;
-	SDL_DestroyTexture (tex) ;
+	floodx (col, tar, cx, cy, vl, vr, vt, vb, 1) ;
 }
 
 /*****************************************************************\
@@ -501,6 +527,7 @@ static void blob (void)
 	if ((cursa & BIT6) != 0)
 		return ;
 
+	glyphflush () ;
 	tex = SDL_CreateTexture (memhdc, SDL_PIXELFORMAT_ABGR8888, SDL_TEXTUREACCESS_STREAMING,
 				 rect.w, rect.h) ;
 	SDL_LockTexture (tex, NULL, (void **) &pixels, &pitch) ;
@@ -534,6 +561,8 @@ static void cls (void)
 	int octl, ocbr ;     // (wide) character offset from start of line
 	SDL_Rect rect = {textwl, textwt, textwr - textwl, textwb - textwt} ;
 
+	glyphflush () ;
+
 	// Find character coordinates from pixel coordinates:
 	p2c (textwl, textwt, &pctl, &sl, &nc, &octl) ; // top-left (inside)
 	p2c (textwr, textwb, &pcbr, &sl, &nc, &ocbr) ; // bottom-right (outside)
@@ -916,23 +945,222 @@ static short getch (int x, int y)
 *       Text output support functions                             *
 \*****************************************************************/
 
-// Outout a proportional-spaced character to the screen.
+// Characters are drawn from texture atlases: the bitmap font's (see
+// characterAtlas) and up to TTFPAGES pages of TrueType glyphs, the least
+// recently used page being emptied when they are all full.  Runs of
+// characters are queued and drawn with one SDL_RenderGeometry call per
+// atlas, so the queue must be flushed (glyphflush) before any other
+// rendering which might overlap it, or a change of clip rectangle or target.
+#define GLYPHQ 512		// Maximum characters per batch
+#define TTFPAGES 4		// Number of TrueType atlas pages
+#define TTFPAGE 1024		// Width and height of a page
+
+static SDL_Vertex glyphv[GLYPHQ * 4] ;
+static int glyphi[GLYPHQ * 6] ;
+static int glyphn ;		// Number of queued characters
+static SDL_Texture *glyphtex ;	// Atlas of the queued characters
+static SDL_Rect glyphbox ;	// Bounding box of the queued characters
+
+static struct { SDL_Texture *tex ; int x, y, rowh ; unsigned int used ; } ttfpage[TTFPAGES] ;
+static struct { unsigned char page ; unsigned short x, y, w, h ; } ttfglyph[65536] ;
+static unsigned int ttfused ;
+
+// Draw the queued characters:
+void glyphflush (void)
+{
+	if (glyphn == 0)
+		return ;
+	SDL_RenderGeometryBBC (memhdc, glyphtex, glyphv, glyphn * 4, glyphi, glyphn * 6) ;
+	glyphn = 0 ;
+}
+
+// Queue a character from a w x h atlas (or draw it immediately if
+// SDL_RenderGeometry isn't available):
+static void glyphadd (SDL_Texture *tex, SDL_Rect *src, SDL_Rect *dst, int col, int w, int h)
+{
+	static int ready = 0 ;
+	SDL_Vertex *v ;
+	SDL_Color c = {col & 0xFF, (col >> 8) & 0xFF, (col >> 16) & 0xFF, (col >> 24) & 0xFF} ;
+	float u0 = (float) src->x / w, u1 = (float) (src->x + src->w) / w ;
+	float v0 = (float) src->y / h, v1 = (float) (src->y + src->h) / h ;
+	int i ;
+
+	if (SDL_RenderGeometryBBC == NULL)
+	    {
+		SDL_SetTextureColorMod (tex, c.r, c.g, c.b) ;
+		SDL_SetTextureAlphaMod (tex, c.a) ;
+		SDL_RenderCopy (memhdc, tex, src, dst) ;
+		return ;
+	    }
+
+	if (!ready)
+	    {
+		for (i = 0; i < GLYPHQ; i++)
+		    {
+			glyphi[i * 6 + 0] = i * 4 + 0 ;
+			glyphi[i * 6 + 1] = i * 4 + 1 ;
+			glyphi[i * 6 + 2] = i * 4 + 2 ;
+			glyphi[i * 6 + 3] = i * 4 + 2 ;
+			glyphi[i * 6 + 4] = i * 4 + 1 ;
+			glyphi[i * 6 + 5] = i * 4 + 3 ;
+		    }
+		ready = 1 ;
+	    }
+
+	if ((tex != glyphtex) || (glyphn == GLYPHQ))
+	    {
+		glyphflush () ;
+		glyphtex = tex ;
+	    }
+	if (glyphn == 0)
+		glyphbox = *dst ;
+	else
+		SDL_UnionRect (&glyphbox, dst, &glyphbox) ;
+
+	v = glyphv + glyphn++ * 4 ;
+	for (i = 0; i < 4; i++)
+	    {
+		v[i].position.x = dst->x + ((i & 1) ? dst->w : 0) ;
+		v[i].position.y = dst->y + ((i & 2) ? dst->h : 0) ;
+		v[i].tex_coord.x = (i & 1) ? u1 : u0 ;
+		v[i].tex_coord.y = (i & 2) ? v1 : v0 ;
+		v[i].color = c ;
+	    }
+}
+
+// Fill a character cell's background, first drawing any queued characters it overlaps:
+void glyphfill (SDL_Rect *rect)
+{
+	if (glyphn && SDL_HasIntersection (rect, &glyphbox))
+		glyphflush () ;
+	SDL_RenderFillRect (memhdc, rect) ;
+}
+
+// Discard the queue and the TrueType atlas (font change or device reset):
+void glyphreset (void)
+{
+	int i ;
+	glyphflush () ;
+	for (i = 0; i < TTFPAGES; i++)
+		if (ttfpage[i].tex)
+			SDL_DestroyTexture (ttfpage[i].tex) ;
+	memset (ttfpage, 0, sizeof(ttfpage)) ;
+	memset (ttfglyph, 0, sizeof(ttfglyph)) ;
+	glyphtex = NULL ;
+}
+
+// Find room for a w x h glyph in the TrueType atlas, emptying the least
+// recently used page if necessary.  Returns the page number (1-based), or 0:
+static int ttfplace (int w, int h, int *px, int *py)
+{
+	int i, n, lru = 0 ;
+	for (i = 0; i < TTFPAGES; i++)
+	    {
+		if (ttfpage[i].tex == NULL)
+		    {
+			ttfpage[i].tex = SDL_CreateTexture (memhdc, SDL_PIXELFORMAT_ARGB8888,
+					SDL_TEXTUREACCESS_STATIC, TTFPAGE, TTFPAGE) ;
+			if (ttfpage[i].tex == NULL)
+				break ;
+			SDL_SetTextureBlendMode (ttfpage[i].tex, SDL_BLENDMODE_BLEND) ;
+		    }
+		if ((ttfpage[i].x + w) > TTFPAGE)
+		    {
+			ttfpage[i].x = 0 ;
+			ttfpage[i].y += ttfpage[i].rowh ;
+			ttfpage[i].rowh = 0 ;
+		    }
+		if ((ttfpage[i].y + h) <= TTFPAGE)
+			break ;
+		if (ttfpage[i].used < ttfpage[lru].used)
+			lru = i ;
+	    }
+
+	if ((i == TTFPAGES) || (ttfpage[i].tex == NULL))
+	    {
+		i = lru ;
+		if (ttfpage[i].tex == NULL)
+			return 0 ;
+		if (glyphtex == ttfpage[i].tex)
+			glyphflush () ;
+		for (n = 0; n < 65536; n++)
+			if (ttfglyph[n].page == i + 1)
+				ttfglyph[n].page = 0 ;
+		ttfpage[i].x = 0 ;
+		ttfpage[i].y = 0 ;
+		ttfpage[i].rowh = 0 ;
+	    }
+
+	*px = ttfpage[i].x ;
+	*py = ttfpage[i].y ;
+	ttfpage[i].x += w + 1 ;
+	if (ttfpage[i].rowh < (h + 1))
+		ttfpage[i].rowh = h + 1 ;
+	return i + 1 ;
+}
+
+// Output a proportional-spaced character to the screen.
 void charttf(unsigned short ax, int col, SDL_Rect rect)
 {
-	SDL_Texture *tex = TTFcache[ax] ;
-	if (tex == NULL)
+	SDL_Rect src ;
+	int page = ttfglyph[ax].page ;
+	if (page == 0)
 	{
 		SDL_Surface *surf ;
 		SDL_Color white = {0xFF, 0xFF, 0xFF, 0xFF} ;
 		Uint16 wchar[2] = {ax, 0} ;
 		surf = TTF_RenderUNICODE_Blended (hfont, wchar, white) ;
-		tex = SDL_CreateTextureFromSurface (memhdc, surf) ;
+		if (surf == NULL)
+			return ;
+		if ((surf->w >= TTFPAGE) || (surf->h >= TTFPAGE) ||
+		    ((page = ttfplace (surf->w, surf->h, &src.x, &src.y)) == 0))
+		{
+			// Too big for the atlas, draw it directly:
+			SDL_Texture *tex = SDL_CreateTextureFromSurface (memhdc, surf) ;
+			rect.w = surf->w ;
+			rect.h = surf->h ;
+			SDL_FreeSurface (surf) ;
+			glyphflush () ;
+			SDL_SetTextureColorMod (tex, col & 0xFF, (col >> 8) & 0xFF, (col >> 16) & 0xFF) ;
+			SDL_RenderCopy (memhdc, tex, NULL, &rect) ;
+			SDL_DestroyTexture (tex) ;
+			return ;
+		}
+		src.w = surf->w ;
+		src.h = surf->h ;
+		SDL_UpdateTexture (ttfpage[page - 1].tex, &src, surf->pixels, surf->pitch) ;
 		SDL_FreeSurface (surf) ;
-		TTFcache[ax] = tex ;
+		ttfglyph[ax].page = page ;
+		ttfglyph[ax].x = src.x ;
+		ttfglyph[ax].y = src.y ;
+		ttfglyph[ax].w = src.w ;
+		ttfglyph[ax].h = src.h ;
 	}
-	SDL_SetTextureColorMod (tex, col & 0xFF, (col >> 8) & 0xFF, (col >> 16) & 0xFF) ;
-	SDL_QueryTexture (tex, NULL, NULL, &rect.w, &rect.h) ;
-	SDL_RenderCopy (memhdc, tex, NULL, &rect) ;
+	src.x = ttfglyph[ax].x ;
+	src.y = ttfglyph[ax].y ;
+	src.w = rect.w = ttfglyph[ax].w ;
+	src.h = rect.h = ttfglyph[ax].h ;
+	ttfpage[page - 1].used = ++ttfused ;
+	glyphadd (ttfpage[page - 1].tex, &src, &rect, col | 0xFF000000, TTFPAGE, TTFPAGE) ;
+}
+
+// Output a bitmap-font character to the screen.
+void charbmp(unsigned char ax, int col, int cx, int cy)
+{
+	int w, h ;
+	SDL_Rect src, dst ;
+	SDL_Texture *tex = characterAtlas (memhdc, ax, &src, &w, &h) ;
+	if (tex == NULL)
+	{
+		glyphflush () ;
+		characterColor (memhdc, cx, cy, ax, col) ;
+		return ;
+	}
+	dst.x = cx ;
+	dst.y = cy ;
+	dst.w = src.w ;
+	dst.h = src.h ;
+	glyphadd (tex, &src, &dst, col, w, h) ;
 }
 
 // Output a character to the screen.
@@ -948,13 +1176,13 @@ static void charout(unsigned short ax, unsigned char fg, unsigned char bg,
 	if (bg != 0xFF)
 	{
 		setcol (bg) ;
-		SDL_RenderFillRect (memhdc, &rect) ;
+		glyphfill (&rect) ;
 	}
 
 	if ((vflags & UFONT) && ((ax >= 0x100) || (usrchr[ax] == 0)))
 		charttf (ax, col, rect) ;
 	else
-		characterColor (memhdc, cx, cy, ax, col) ;
+		charbmp (ax, col, cx, cy) ;
 	return ;
 }
 
@@ -964,36 +1192,72 @@ static void charout_logic (short ax, short fg, int cx, int cy, int dx)
 	int pitch ;
 	int *p ;
 	unsigned char rop = fg & 7, col = fg >> 8 ;
+	glyphflush () ;
 	if (glLogicOpBBC)
 	    {
-		int c, x, y ;
-		SDL_Rect rect = {0, 0, dx, chary} ;
-		SDL_Texture *tex = SDL_GetRenderTarget (memhdc) ;
-		SDL_Texture *src = SDL_CreateTexture (memhdc, SDL_PIXELFORMAT_ABGR8888,
-				SDL_TEXTUREACCESS_STREAMING, dx, chary) ;
-		SDL_SetRenderTarget (memhdc, NULL) ;
-		SDL_SetRenderDrawColor (memhdc, 0, 0, 0, 0xFF) ;
-		SDL_RenderFillRect (memhdc, &rect) ;
-		charout (ax, 0xFF, 0xFF, 0, 0, dx) ;
-		SDL_LockTexture (src, NULL, (void **) &p, &pitch) ;
-		SDL_RenderReadPixels (memhdc, &rect, SDL_PIXELFORMAT_ABGR8888, p, pitch) ;
-		SDL_SetRenderTarget (memhdc, tex) ;
+		// The glyph is plotted as a mask (colour where set, zero elsewhere)
+		// in one operation, so each plotting mode is mapped to a logical
+		// operation for which a zero source leaves the destination alone:
+		static short maskop[] = {0, 0x1507, 0x1504, 0x1506, 0x1506, 0x1505, 0x1504, 0x1507} ;
+		static char maskinv[] = {0, 0, 1, 0, 2, 0, 0, 1} ;
+		int w, h ;
+		unsigned int rgba = palette[col] ;
+		SDL_Rect src, rect = {cx, cy, dx, chary} ;
+		SDL_Texture *tex = NULL, *mask = NULL ;
+
+		if (rop == 5)
+			return ;
+		if (maskinv[rop] == 1)
+			rgba = ~rgba ;	// AND col = AND_INVERTED NOT col etc.
+		if (maskinv[rop] == 2)
+			rgba = 0xFFFFFFFF ;	// NOT = XOR white
+
+		if (!((vflags & UFONT) && ((ax >= 0x100) || (usrchr[ax] == 0))))
+			tex = characterAtlas (memhdc, ax, &src, &w, &h) ;
+		if (tex)
+		    {
+			if (src.w > dx) src.w = dx ;
+			if (src.h > chary) src.h = chary ;
+			rect.w = src.w ;
+			rect.h = src.h ;
+		    }
+		else
+		    {
+			// Not in the atlas, so render it and read it back:
+			int x, y ;
+			SDL_Rect box = {0, 0, dx, chary} ;
+			SDL_Texture *target = SDL_GetRenderTarget (memhdc) ;
+			mask = SDL_CreateTexture (memhdc, SDL_PIXELFORMAT_ABGR8888,
+					SDL_TEXTUREACCESS_STREAMING, dx, chary) ;
+			SDL_SetRenderTarget (memhdc, NULL) ;
+			SDL_SetRenderDrawColor (memhdc, 0, 0, 0, 0xFF) ;
+			SDL_RenderFillRect (memhdc, &box) ;
+			charout (ax, 0xFF, 0xFF, 0, 0, dx) ;
+			glyphflush () ;
+			SDL_LockTexture (mask, NULL, (void **) &p, &pitch) ;
+			SDL_RenderReadPixels (memhdc, &box, SDL_PIXELFORMAT_ABGR8888, p, pitch) ;
+			for (y = 0; y < chary; y++, p += pitch / 4)
+				for (x = 0; x < dx; x++)
+					p[x] = (p[x] & 0x8000) ? 0xFFFFFFFF : 0 ;
+			SDL_UnlockTexture (mask) ;
+			SDL_SetRenderTarget (memhdc, target) ;
+			src = box ;
+			tex = mask ;
+		    }
+
+		SDL_SetTextureColorMod (tex, rgba & 0xFF, (rgba >> 8) & 0xFF, (rgba >> 16) & 0xFF) ;
+		SDL_SetTextureAlphaMod (tex, rgba >> 24) ;
 		BBC_RenderSetClipRect (memhdc, hrect) ;
-			if (SDL_RenderFlushBBC) SDL_RenderFlushBBC (memhdc) ;
+		if (SDL_RenderFlushBBC) SDL_RenderFlushBBC (memhdc) ;
 		glEnableBBC (GL_COLOR_LOGIC_OP) ;
-		glLogicOpBBC (logicop[rop]) ;
-		setcol (col) ;
-		for (y = cy; y < (cy + chary); y++)
-			for (x = cx; x < (cx + dx); x++)
-			    {
-				c = *p++ ;
-				if (c & 0x8000)
-					SDL_RenderDrawPoint(memhdc, x, y) ;
-			    }
+		glLogicOpBBC (maskop[rop]) ;
+		SDL_RenderCopy (memhdc, tex, &src, &rect) ;
 		if (SDL_RenderFlushBBC) SDL_RenderFlushBBC (memhdc) ;
 		glDisableBBC (GL_COLOR_LOGIC_OP) ;
-		SDL_UnlockTexture (src) ;
-		SDL_DestroyTexture (src) ;
+		SDL_SetTextureColorMod (tex, 0xFF, 0xFF, 0xFF) ;
+		SDL_SetTextureAlphaMod (tex, 0xFF) ;
+		if (mask)
+			SDL_DestroyTexture (mask) ;
 	    }
 	else
 	    {
@@ -1014,6 +1278,7 @@ static void charout_logic (short ax, short fg, int cx, int cy, int dx)
 		if (rop == 4) { palette[255] = 0xFFFFFFFF ; col = 255 ; }
 		if (rop >= 6) { palette[255] = palette[col] ^ 0xFFFFFF; col = 255; }
 		charout (ax, col, 0xFF, cx, cy, dx) ;
+		glyphflush () ;
 		SDL_RenderCopy (memhdc, tex, NULL, &rect) ;
 		SDL_DestroyTexture (tex) ;
 	    }
@@ -1123,6 +1388,8 @@ static void sendg (short ch)
 		int oc ;    // (wide) character offset from start of line
 		p2c (lastx, lasty, &pc, &sl, &nc, &oc) ;
 		*pc = ch ;
+		if (modeno == 7)
+			dirty7 (sl) ;
 	}
 
 	if (forgnd & 0xFF)
@@ -1141,6 +1408,7 @@ static void sendg (short ch)
 			charout(ch, forgnd >> 8, 0xFF, lastx, lasty, dx) ;
 	}
 
+	glyphflush () ;
 	SDL_RenderSetClipRect (memhdc, NULL) ;
 	bChanged = 1 ;
 
@@ -1254,6 +1522,7 @@ static void newmode (short wx, short wy, short cx, short cy, short nc, signed ch
 	cursb = cy ;
 	colmsk = nc - 1 ;
 
+	glyphflush () ;
 	tex = SDL_GetRenderTarget (memhdc) ;
 	SDL_SetRenderTarget (memhdc, NULL) ;
 #if defined(__ANDROID__) || defined(__IPHONEOS__)
@@ -1647,6 +1916,7 @@ static void plotns (unsigned char al, int cx, int cy)
 		break ;
 	}
 
+	glyphflush () ;
 	SDL_RenderSetClipRect (memhdc, NULL) ;
 	if (rop != 0)
 	    {
@@ -1914,6 +2184,7 @@ static void gwind (short sl, short sb, short sr, short st)
 static void reswin (void)
 {
 	int w = 0, h = 0 ;
+	glyphflush () ;
 	SDL_GL_GetDrawableSize (hwndProg, &w, &h) ;
 	if ((w != 0) && (h != 0))
 	    {
@@ -1991,6 +2262,7 @@ void xeqvdu_ (int data2, int data1, int code)
 {
 	int vdu = code >> 8 ;
 
+	glyphflush () ;
 	if ((vflags & VDUDIS) && (vdu != 1) && (vdu != 6))
 	  psend (vdu) ;
 	else
@@ -2208,19 +2480,13 @@ int getwid_ (int l, char *s)
 // OPENFONT
 TTF_Font *openfont_ (char *filename, int sizestyle)
 {
-	SDL_Texture **p ;
 	if (hfont)
 		{
 			TTF_CloseFont (hfont) ;
 			hfont = NULL ;
 		}
 
-	for (p = TTFcache; p < TTFcache + 65536; p++)
-		if (*p != NULL)
-		{
-			SDL_DestroyTexture (*p) ;
-			*p = NULL ;
-		}
+	glyphreset () ;
 
 	vflags &= ~UFONT ;
 	if ((sizestyle & 0xFFFF) == 0)	// default font?
@@ -2340,6 +2606,7 @@ void vduchr_ (short ucs2)
 		fmove (6) ;
 		BBC_RenderSetClipRect (memhdc, hrect) ;
 		charout(' ', 0xFF, bakgnd >> 8, lastx, lasty, charx) ;
+		glyphflush () ;
 		SDL_RenderSetClipRect (memhdc, NULL) ;
 		bChanged = 1 ;
 	  }
@@ -2457,6 +2724,7 @@ int disply_ (SDL_Rect *dst, SDL_Surface *surf)
 {
 	int flip = 0 ;
 	SDL_Texture *tex ;
+	glyphflush () ;
 	ascale (&dst->x, &dst->y) ;
 	tex = SDL_CreateTextureFromSurface (memhdc, surf) ;
 	SDL_FreeSurface (surf) ;
@@ -2487,6 +2755,7 @@ int disply_ (SDL_Rect *dst, SDL_Surface *surf)
 // Read pixels (for *GSAVE/*SCREENSAVE):
 void getpix_ (SDL_Rect *src, void *buffer)
 {
+	glyphflush () ;
 #ifdef __EMSCRIPTEN__
 	int i, j, k = src->h - 1 ;
 	int pitch = (src->w * 3 + 3) & -4 ;
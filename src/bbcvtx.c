@@ -24,12 +24,21 @@
 #define	SEPSIZ	4       // Width/height of separated
 
 void charttf(unsigned short ax, int col, SDL_Rect rect) ;
+void charbmp(unsigned char ax, int col, int cx, int cy) ;
+void glyphfill (SDL_Rect *rect) ;
+void glyphflush (void) ;
 
 //Code conversion for special symbols:
 unsigned char frigo[] = {0x23,0x5B,0x5C,0x5D,0x5E,0x5F,0x60,0x7B,0x7C,0x7D,0x7E,0x7F} ;
 unsigned char frign[] = { 163, 143, 189, 144, 141,  35, 151, 188, 157, 190, 247, 129} ; // not 035
 unsigned short frigw[] = {0xA3,0x2190,0xBD,0x2192,0x2191,0x23,0x2014,0xBC,0x2016,0xBE,0xF7,0x25A0} ;
 
+// State of each row, as found by the last full pass over it:
+//	 bit 7  - state valid (row unchanged since)
+//	 bit 5  - row contains double-height characters
+//	 bit 0  - row contains flashing characters
+static unsigned char rowstat[25] ;
+
 static int rgbtab[] = {
 		0xFF000000,	// black
         	0xFFFF0000,	// blue
@@ -86,6 +95,14 @@ static char ctab7[] = {
 		0xF0,	// 0b11110000: Hold graphics
 		0x08} ;	// 0b00001000: Release graphics
 
+// Note that a row of the character map has changed:
+void dirty7 (short *sl)
+{
+	int row = (sl - chrmap) / ((XSCREEN + 7) >> 3) ;
+	if ((row >= 0) && (row < 25))
+		rowstat[row] = 0 ;
+}
+
 // Check if row contains any double-height characters:
 static int anydh (short *sl)
 {
@@ -140,7 +157,7 @@ static void chout7 (unsigned char al, unsigned char ah, int xpos, int ypos)
 	SDL_Rect rect = {xpos, ypos, CHARX, CHARY} ;
 
 	setrgb (ah >> 4) ;	// background colour
-	SDL_RenderFillRect (memhdc, &rect) ;
+	glyphfill (&rect) ;
 
 	if ((al & 0x5F) == 0)
 		al = ' ' ;
@@ -161,7 +178,7 @@ static void chout7 (unsigned char al, unsigned char ah, int xpos, int ypos)
 		    }
 		else
 		    {
-			characterColor (memhdc, xpos, ypos, al, rgbtab[ah & 7]) ;
+			charbmp (al, rgbtab[ah & 7], xpos, ypos) ;
 		    }
 		return ;
 	}
@@ -211,6 +228,7 @@ static void outch7 (unsigned char al, unsigned char ah, unsigned char mode, int
 		SDL_Rect dst = {xpos, ypos, CHARX, CHARY} ;
 		SDL_Texture *tex, *target ;
 
+		glyphflush () ;
 		if (mode & BIT3)
 			src.y += CHARY/2 ;	// bottom half
 		tex = SDL_CreateTexture (memhdc, SDL_PIXELFORMAT_ABGR8888,
@@ -427,6 +445,7 @@ void send7 (unsigned char al, short *pc, short *sl, int ypos)
 	if (al == ah)
 		return ;
 	*pc = al ;
+	dirty7 (sl) ;
 
 	attr = 7 ;
 	mode = 0x10 ;
@@ -461,7 +480,8 @@ void send7 (unsigned char al, short *pc, short *sl, int ypos)
 	}
 }
 
-// Update the entire Viewdata screen
+// Update the entire Viewdata screen (flag = 0 for a flash update,
+// which skips unchanged rows that have no flashing characters)
 static void update7 (unsigned char flag)
 {
 	int row, ypos = 0 ;
@@ -474,15 +494,26 @@ static void update7 (unsigned char flag)
 		int col, xpos = 0 ;
 		char held = 0 ;		// Held graphics character
 		unsigned char sticky = flag ;	// To detect any D/H
+		unsigned char flash = 0 ;	// To detect any flashing
 		attr = 7 ; 		// Initial attributes
-		for (col = 0; col < 40; col++)
+		if ((flag == 0) && ((rowstat[row] & (BIT7 | BIT0)) == BIT7))
 		{
-			short atch = char7 (pc, &attr, &mode, &held) ;
-			sticky |= mode ;
-			if ((atch & 0x8000) || (sticky & BIT0))
-				outch7 (atch & 0xFF, atch >> 8, mode, xpos, ypos) ; 
-			pc++ ;
-			xpos += CHARX ;
+			sticky = rowstat[row] ;	// n.b. mode BIT3 is unchanged
+			pc += 40 ;
+		}
+		else
+		{
+			for (col = 0; col < 40; col++)
+			{
+				short atch = char7 (pc, &attr, &mode, &held) ;
+				sticky |= mode ;
+				flash |= atch >> 8 ;
+				if ((atch & 0x8000) || (sticky & BIT0))
+					outch7 (atch & 0xFF, atch >> 8, mode, xpos, ypos) ; 
+				pc++ ;
+				xpos += CHARX ;
+			}
+			rowstat[row] = BIT7 | (sticky & BIT5) | ((flash & BIT7) >> 7) ;
 		}
 		pc += ((XSCREEN + 7) >> 3) - 40 ;
 		ypos += CHARY ;
@@ -490,6 +521,7 @@ static void update7 (unsigned char flag)
 		if ((sticky & BIT5) == 0)
 			mode = 0x10 ;
 	}
+	glyphflush () ;
 }
 
 // Flip the state of flashing characters:
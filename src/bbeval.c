@@ -20,6 +20,20 @@
 #include <setjmp.h>
 #include "BBC.h"
 
+#if defined __SSE2__
+#include <emmintrin.h>
+#elif defined __ARM_NEON
+#include <arm_neon.h>
+#endif
+
+// Large matrix products (array dot operator) are shared between up to four threads:
+#if !defined __EMSCRIPTEN__ && !defined __riscv__ && !defined PICO
+#define GEMM_THREADS
+#include <pthread.h>
+#endif
+#define MTGEMM 1000000	// Minimum number of multiply-adds to use threads
+#define GEMMKB 256	// Inner dimension block size (keeps B panel in L1 cache)
+
 #if defined __riscv__
 
 #define floorl floor
@@ -164,6 +178,7 @@ int widths (char *, int) ;	// Get string width in graphics units
 int adval (int) ;		// ADVAL function
 void *osopen (int, char *) ;	// Open a file
 unsigned char osbget (void*, int*) ; // Get a byte from a file
+int osbgets (void*, char*, int, int, int*) ; // Get a line from a file
 long long getptr (void*) ;	// Get file pointer
 long long getext (void*) ;	// Get file length
 long long geteof (void*) ;	// Get EOF status
@@ -171,13 +186,17 @@ void *sysadr (char *) ;		// Get the address of an API function
 
 // Global jump buffer:
 extern jmp_buf env ;
+extern unsigned char fastxq ;	// *TURBO mode
+extern heapptr *sysesp ;	// Stack pointer at SYS
 
 #if defined __arm__ || defined __aarch64__ || defined __EMSCRIPTEN__ || defined __ANDROID__ || defined __riscv__
 static void setfpu(void) {}
+typedef double REAL ;
 static double xpower[9] = {1.0e1, 1.0e2, 1.0e4, 1.0e8, 1.0e16, 1.0e32, 1.0e64,
 			   1.0e128, 1.0e256} ;
 #else
 static void setfpu(void) { unsigned int mode = 0x37F; asm ("fldcw %0" : : "m" (*&mode)); }
+typedef long double REAL ;
 static long double xpower[13] = {1.0e1L, 1.0e2L, 1.0e4L, 1.0e8L, 1.0e16L, 1.0e32L, 1.0e64L,
 				1.0e128L, 1.0e256L, 1.0e512L, 1.0e1024L, 1.0e2048L, 1.0e4096L} ;
 #endif
@@ -413,6 +432,123 @@ VAR con (void)
 	return v ;
 }
 
+// Cache of decoded numeric constants (*TURBO ON), so that a literal in
+// the program is converted from decimal only on its first evaluation.
+// Like the variable cache in bbmain, it is emptied by clear():
+#ifdef PICO
+#define CCBITS 6
+#else
+#define CCBITS 10
+#endif
+#define CCSIZE (1 << CCBITS)
+static struct { heapptr site ; unsigned char len ; unsigned char lc ; VAR v ; } ccache[CCSIZE] ;
+static int ccused ;
+static heapptr cclo, cchi ;	// Range of cacheable sites
+
+void clrcon (signed char *top)
+{
+	if (ccused)
+		memset (ccache, 0, sizeof(ccache)) ;
+	ccused = 0 ;
+	cclo = vpage ;
+	cchi = top - (signed char *) zero ;
+}
+
+// Get an unsigned numeric constant, from the cache if possible:
+static VAR conc (void)
+{
+	VAR v ;
+	unsigned int slot ;
+	unsigned char lc = liston & BIT3 ;
+	heapptr site = esi - (signed char *) zero ;
+
+	if ((fastxq == 0) || (site < cclo) || (site >= cchi))
+		return con () ;
+
+	slot = ((unsigned int) site * 2654435761U) >> (32 - CCBITS) ;
+	if ((ccache[slot].site == site) && (ccache[slot].lc == lc))
+	    {
+		esi += ccache[slot].len ;
+		return ccache[slot].v ;
+	    }
+
+	v = con () ;
+	if (esi - (site + (signed char *) zero) <= 255)
+	    {
+		ccache[slot].site = site ;
+		ccache[slot].len = esi - (site + (signed char *) zero) ;
+		ccache[slot].lc = lc ;
+		ccache[slot].v = v ;
+		ccused = 1 ;
+	    }
+	return v ;
+}
+
+// Cache of tokenised EVAL strings, most recently used first.  The key is
+// the source text (and the *LOWERCASE state), so it never needs emptying:
+#define ECSIZE 16
+static struct ecent { unsigned int hash ; int len ; int tlen ; unsigned char lc ; char *src ; } ecache[ECSIZE] ;
+static long long ecstat[2] ; // hits, misses
+
+// Tokenise the CR-terminated string of length len in accs into dst (which
+// may be accs), from the cache if possible:
+static void evalex (int len, char *dst)
+{
+	struct ecent e ;
+	unsigned int hash = 2166136261U ;
+	unsigned char lc = liston & BIT3 ;
+	char *p ;
+	int i ;
+
+	for (i = 0; i < len; i++)
+		hash = (hash ^ (unsigned char) accs[i]) * 16777619U ;
+
+	for (i = 0; (i < ECSIZE) && ecache[i].src; i++)
+		if ((ecache[i].hash == hash) && (ecache[i].len == len) &&
+		    (ecache[i].lc == lc) && (memcmp (ecache[i].src, accs, len) == 0))
+		    {
+			e = ecache[i] ;
+			memmove (ecache + 1, ecache, i * sizeof(e)) ;
+			ecache[0] = e ;
+			memcpy (dst, e.src + len, e.tlen) ;
+			ecstat[0]++ ;
+			return ;
+		    }
+	ecstat[1]++ ;
+
+	p = malloc (len) ;
+	if (p)
+		memcpy (p, accs, len) ;
+	i = lexan (accs, dst, 0) - dst ;
+	if (p == NULL)
+		return ;
+	e.src = realloc (p, len + i) ;
+	if (e.src == NULL)
+	    {
+		free (p) ;
+		return ;
+	    }
+	memcpy (e.src + len, dst, i) ;
+	e.hash = hash ;
+	e.len = len ;
+	e.tlen = i ;
+	e.lc = lc ;
+	free (ecache[ECSIZE - 1].src) ;
+	memmove (ecache + 1, ecache, (ECSIZE - 1) * sizeof(e)) ;
+	ecache[0] = e ;
+}
+
+// Return (and optionally reset) the EVAL cache hits and misses,
+// accessible from BASIC as SYS "BBC_EvalStats", reset% TO stats%%
+long long *evalstats (int reset)
+{
+	static long long stats[2] ;
+	memcpy (stats, ecstat, sizeof(stats)) ;
+	if (reset)
+		memset (ecstat, 0, sizeof(ecstat)) ;
+	return stats ;
+}
+
 // Get a string constant (quoted string):
 VAR cons (void)
 {
@@ -1067,6 +1203,457 @@ static int dimfunc (void)
 	return ILOAD(ptr + 1 + n * 4) - 1 ;
 }
 
+// Whole-array reductions used by SUM and MOD (and by arrstats).  Integer (%)
+// elements are summed exactly in 64 bits.  Float (#) elements are summed in
+// double precision, pairwise: blocks are split recursively in half and each
+// leaf is added into eight independent SIMD lanes (GCC vector extension).
+
+typedef double v2df __attribute__ ((vector_size (16), aligned (8))) ;
+typedef long long v2di __attribute__ ((vector_size (16), aligned (8))) ;
+
+#define PAIRLEAF 1024
+
+// Sum (sq = 0) or sum of squares (sq = 1) of n # elements; *pbad is set
+// non-zero if any is in integer format (MS word zero, except +0.0).  Such a
+// value, as a double, is a positive denormal less than 2^-1042:
+static double pairf64 (const char *p, int n, int sq, v2di *pbad)
+{
+	const v2df nil = {0.0, 0.0}, tiny = {0x1p-1042, 0x1p-1042} ;
+	v2df s0 = nil, s1 = nil, s2 = nil, s3 = nil ;
+	v2di bad = {0, 0} ;
+	double s, t ;
+	int i ;
+
+	if (n > PAIRLEAF)
+	    {
+		int h = (n / 2) & ~7 ;
+		return pairf64 (p, h, sq, pbad) + pairf64 (p + h * 8, n - h, sq, pbad) ;
+	    }
+
+	for (i = 0 ; i <= n - 8; i += 8)
+	    {
+		v2df a, b, c, d ;
+		memcpy (&a, p + i * 8, 16) ;
+		memcpy (&b, p + i * 8 + 16, 16) ;
+		memcpy (&c, p + i * 8 + 32, 16) ;
+		memcpy (&d, p + i * 8 + 48, 16) ;
+		bad |= ((a > nil) & (a < tiny)) | ((b > nil) & (b < tiny)) |
+		       ((c > nil) & (c < tiny)) | ((d > nil) & (d < tiny)) ;
+		if (sq)
+		    {
+			a *= a ; b *= b ; c *= c ; d *= d ;
+		    }
+		s0 += a ; s1 += b ; s2 += c ; s3 += d ;
+	    }
+	s0 = (s0 + s1) + (s2 + s3) ;
+	s = s0[0] + s0[1] ;
+	for ( ; i < n; i++)
+	    {
+		memcpy (&t, p + i * 8, 8) ;
+		if ((t > 0.0) && (t < 0x1p-1042))
+			bad[0] = -1 ;
+		s += sq ? t * t : t ;
+	    }
+	*pbad |= bad ;
+	return s ;
+}
+
+// Sum (sq = 0) or sum of squares (sq = 1) of a # array.  Returns 0 (leaving
+// the generic code to do it) if an element is in integer format or the
+// result isn't finite, else 1, or 2 if every element is +0.0 (in which case
+// loadn() and math() would have returned integer zero):
+static int sumf64 (const char *p, int n, int sq, double *psum)
+{
+	v2di bad = {0, 0} ;
+	double s = pairf64 (p, n, sq, &bad) ;
+	if ((bad[0] | bad[1]) || !isfinite (s))
+		return 0 ;
+	*psum = s ;
+	if (s == 0.0)
+	    {
+		int i ;
+		for (i = 0; i < n; i++)
+			if (ILOAD(p + i * 8) || ILOAD(p + i * 8 + 4))
+				return 1 ;
+		return 2 ;
+	    }
+	return 1 ;
+}
+
+// Sum of a % array; can't overflow 64 bits:
+static long long sumi32 (const char *p, int n)
+{
+	long long s = 0 ;
+	int i = 0 ;
+#if defined __SSE2__
+	__m128i acc = _mm_setzero_si128 () ;
+	long long t[2] ;
+	for ( ; i <= n - 4; i += 4)
+	    {
+		__m128i a = _mm_loadu_si128 ((__m128i *)(p + i * 4)) ;
+		__m128i sign = _mm_srai_epi32 (a, 31) ;
+		acc = _mm_add_epi64 (acc, _mm_unpacklo_epi32 (a, sign)) ;
+		acc = _mm_add_epi64 (acc, _mm_unpackhi_epi32 (a, sign)) ;
+	    }
+	_mm_storeu_si128 ((__m128i *) t, acc) ;
+	s = t[0] + t[1] ;
+#elif defined __ARM_NEON
+	int64x2_t acc = vdupq_n_s64 (0) ;
+	for ( ; i <= n - 4; i += 4)
+		acc = vpadalq_s32 (acc, vld1q_s32 ((int32_t *)(p + i * 4))) ;
+	s = vgetq_lane_s64 (acc, 0) + vgetq_lane_s64 (acc, 1) ;
+#endif
+	for ( ; i < n; i++)
+		s += ILOAD(p + i * 4) ;
+	return s ;
+}
+
+// Sum of squares of a % array; returns 0 if it overflows 63 bits:
+static int sqsi32 (const char *p, int n, long long *psum)
+{
+	unsigned long long s = 0, q ;
+	int i ;
+	for (i = 0; i < n; i++)
+	    {
+		q = (long long) ILOAD(p + i * 4) * ILOAD(p + i * 4) ;
+		s += q ;
+		if ((s < q) || (s > 0x7FFFFFFFFFFFFFFFULL))
+			return 0 ;
+	    }
+	*psum = s ;
+	return 1 ;
+}
+
+// Sum of a %% array; returns 0 if it overflows (math() would then switch
+// to floating point):
+static int sumi64 (const char *p, int n, long long *psum)
+{
+	unsigned long long s = 0 ;
+	long long a, r ;
+	int i ;
+	for (i = 0; i < n; i++)
+	    {
+		memcpy (&a, p + i * 8, 8) ;
+		r = (long long) (s + (unsigned long long) a) ;
+		if (((a ^ r) & ((long long) s ^ r)) < 0)
+			return 0 ;
+		s = r ;
+	    }
+	*psum = s ;
+	return 1 ;
+}
+
+// SUM of a numeric array, or MOD (sq = 1) before the square root.
+// Returns 0 if there's no fast path for the type or the generic loop is
+// needed to get the same result (or error):
+static int arrsum (void *ptr, int count, unsigned char type, int sq, VAR *pv)
+{
+	int i ;
+	double f ;
+	long long n = 0 ;
+	switch (type)
+	    {
+		case 1:
+			if (sq)
+				return 0 ;
+			for (i = 0; i < count; i++)
+				n += *((unsigned char *) ptr + i) ;
+			break ;
+
+		case 4:
+			if (sq)
+			    {
+				if (!sqsi32 (ptr, count, &n))
+					return 0 ;
+			    }
+			else
+				n = sumi32 (ptr, count) ;
+			break ;
+
+		case 40:
+			if (sq || !sumi64 (ptr, count, &n))
+				return 0 ;
+			break ;
+
+		case 8:
+			i = sumf64 (ptr, count, sq, &f) ;
+			if (i == 0)
+				return 0 ;
+			if (i == 2)
+				break ;
+			pv->i.t = 1 ; // ARM
+			pv->f = f ;
+			return 1 ;
+
+		default:
+			return 0 ;
+	    }
+	pv->i.t = 0 ;
+	pv->i.n = n ;
+	return 1 ;
+}
+
+// Total length of the strings in a string array (SUMLEN):
+static int arrlens (void *ptr, int count, unsigned char type)
+{
+	int n = 0 ;
+	if (type == 136)
+	    {
+		while (count--)
+		    {
+			n += ILOAD(ptr + 4) ;
+			ptr += 8 ;
+		    }
+	    }
+	else
+		while (count--)
+		    {
+			n += loads (ptr, type).s.l ;
+			ptr += 8 ;
+		    }
+	return n ;
+}
+
+// Minimum, maximum, mean and (first) indices of the minimum and maximum of
+// n array elements, accessible from BASIC as
+// SYS "BBC_ArrayStats", ^a(0), n%, type%, ^s#(0) TO ok%
+// where type% is 1 (&), 4 (%), 8 (#) or 40 (%%) and s#(0) to s#(4) receive
+// the results in that order.  Returns zero if the type isn't supported:
+int arrstats (void *ptr, int n, int type, double *out)
+{
+	double x = 0, min = 0, max = 0 ;
+	REAL sum = 0 ;
+	int i, imin = 0, imax = 0 ;
+	VAR v ;
+
+	if ((n <= 0) || ((type != 1) && (type != 4) && (type != 8) && (type != 40)))
+		return 0 ;
+	for (i = 0; i < n; i++)
+	    {
+		if (type == 4)
+			x = ILOAD(ptr + i * 4) ;
+		else if (type == 1)
+			x = *((unsigned char *) ptr + i) ;
+		else
+		    {
+			v = loadn (ptr + i * 8, type) ;
+			x = v.i.t ? v.f : v.i.n ;
+		    }
+		if ((i == 0) || (x < min))
+		    {
+			min = x ;
+			imin = i ;
+		    }
+		if ((i == 0) || (x > max))
+		    {
+			max = x ;
+			imax = i ;
+		    }
+	    }
+	if (arrsum (ptr, n, type, 0, &v))
+		sum = v.i.t ? v.f : v.i.n ;
+	else
+		for (i = 0; i < n; i++) // # or %% only
+		    {
+			v = loadn (ptr + i * 8, type) ;
+			sum += v.i.t ? v.f : v.i.n ;
+		    }
+	out[0] = min ;
+	out[1] = max ;
+	out[2] = sum / n ;
+	out[3] = imin ;
+	out[4] = imax ;
+	return 1 ;
+}
+
+// Substring search, used by INSTR and the BBC_Mem* functions.  Needles
+// shorter than SRCHLONG are located by testing their first and last bytes
+// at 16 positions at once (SSE2 or NEON), only candidates which match both
+// being compared in full; longer needles use Horspool's bad-character shift.
+
+#define SRCHLONG 32
+
+#if defined __SSE2__
+#define SRCHBITS 1
+// One bit per position where hay[i] == f and hay[i + n - 1] == l:
+static inline unsigned long long srchmask (const char *p, int n, char f, char l)
+{
+	__m128i a = _mm_loadu_si128 ((__m128i *) p) ;
+	__m128i b = _mm_loadu_si128 ((__m128i *)(p + n - 1)) ;
+	return _mm_movemask_epi8 (_mm_and_si128 (_mm_cmpeq_epi8 (a, _mm_set1_epi8 (f)),
+						 _mm_cmpeq_epi8 (b, _mm_set1_epi8 (l)))) ;
+}
+#elif defined __ARM_NEON
+#define SRCHBITS 4
+// Four bits per position where hay[i] == f and hay[i + n - 1] == l:
+static inline unsigned long long srchmask (const char *p, int n, char f, char l)
+{
+	uint8x16_t a = vceqq_u8 (vld1q_u8 ((uint8_t *) p), vdupq_n_u8 (f)) ;
+	uint8x16_t b = vceqq_u8 (vld1q_u8 ((uint8_t *)(p + n - 1)), vdupq_n_u8 (l)) ;
+	uint8x8_t m = vshrn_n_u16 (vreinterpretq_u16_u8 (vandq_u8 (a, b)), 4) ;
+	return vget_lane_u64 (vreinterpret_u64_u8 (m), 0) ;
+}
+#endif
+
+// Find the first occurrence of ndl (nlen >= 1) in hay, or NULL:
+static const char *fwdsrch (const char *hay, int hlen, const char *ndl, int nlen)
+{
+	int i = 0, last = hlen - nlen ; // last possible start
+	char f = ndl[0], l = ndl[nlen - 1] ;
+
+	if (last < 0)
+		return NULL ;
+	if (nlen == 1)
+		return memchr (hay, f, hlen) ;
+
+	if (nlen >= SRCHLONG)
+	    {
+		int shift[256] ;
+		for (i = 0; i < 256; i++)
+			shift[i] = nlen ;
+		for (i = 0; i < nlen - 1; i++)
+			shift[(unsigned char) ndl[i]] = nlen - 1 - i ;
+		for (i = 0; i <= last; i += shift[(unsigned char) hay[i + nlen - 1]])
+			if ((hay[i + nlen - 1] == l) && (memcmp (hay + i, ndl, nlen - 1) == 0))
+				return hay + i ;
+		return NULL ;
+	    }
+
+#ifdef SRCHBITS
+	for ( ; i <= last - 15; i += 16)
+	    {
+		unsigned long long m = srchmask (hay + i, nlen, f, l) ;
+		while (m)
+		    {
+			int j = __builtin_ctzll (m) / SRCHBITS ;
+			if (memcmp (hay + i + j + 1, ndl + 1, nlen - 2) == 0)
+				return hay + i + j ;
+			m &= ~(((1ULL << SRCHBITS) - 1) << (j * SRCHBITS)) ;
+		    }
+	    }
+#endif
+	while (i <= last)
+	    {
+		const char *p = memchr (hay + i, f, last - i + 1) ;
+		if (p == NULL)
+			break ;
+		i = p - hay ;
+		if ((p[nlen - 1] == l) && (memcmp (p + 1, ndl + 1, nlen - 2) == 0))
+			return p ;
+		i++ ;
+	    }
+	return NULL ;
+}
+
+// Find the last occurrence of ndl (nlen >= 1) in hay, or NULL:
+static const char *revsrch (const char *hay, int hlen, const char *ndl, int nlen)
+{
+	int i = hlen - nlen ; // last possible start
+	char f = ndl[0], l = ndl[nlen - 1] ;
+
+	if (i < 0)
+		return NULL ;
+
+	if (nlen >= SRCHLONG)
+	    {
+		int k, shift[256] ;
+		for (k = 0; k < 256; k++)
+			shift[k] = nlen ;
+		for (k = nlen - 1; k > 0; k--)
+			shift[(unsigned char) ndl[k]] = k ;
+		for ( ; i >= 0; i -= shift[(unsigned char) hay[i]])
+			if ((hay[i] == f) && (memcmp (hay + i + 1, ndl + 1, nlen - 1) == 0))
+				return hay + i ;
+		return NULL ;
+	    }
+
+#ifdef SRCHBITS
+	for ( ; i >= 15; i -= 16)
+	    {
+		unsigned long long m = srchmask (hay + i - 15, nlen, f, l) ;
+		while (m)
+		    {
+			int j = (63 - __builtin_clzll (m)) / SRCHBITS ;
+			if ((nlen == 1) || (memcmp (hay + i - 15 + j + 1, ndl + 1, nlen - 2) == 0))
+				return hay + i - 15 + j ;
+			m &= ~(((1ULL << SRCHBITS) - 1) << (j * SRCHBITS)) ;
+		    }
+	    }
+#endif
+	for ( ; i >= 0; i--)
+		if ((hay[i] == f) && (hay[i + nlen - 1] == l) &&
+		    ((nlen == 1) || (memcmp (hay + i + 1, ndl + 1, nlen - 2) == 0)))
+			return hay + i ;
+	return NULL ;
+}
+
+// Search a block of memory for a string, accessible from BASIC as
+// SYS "BBC_MemSearch", addr%%, size%, needle$, LEN(needle$) TO offset%
+// Returns the 1-based offset of the first occurrence, or 0 if none:
+int memsrch (const char *hay, int hlen, const char *ndl, int nlen)
+{
+	const char *p ;
+	if ((hlen <= 0) || (nlen <= 0))
+		return 0 ;
+	p = fwdsrch (hay, hlen, ndl, nlen) ;
+	return p ? p - hay + 1 : 0 ;
+}
+
+// As memsrch but returns the offset of the last occurrence
+// (SYS "BBC_MemSearchRev"):
+int memrsrch (const char *hay, int hlen, const char *ndl, int nlen)
+{
+	const char *p ;
+	if ((hlen <= 0) || (nlen <= 0))
+		return 0 ;
+	p = revsrch (hay, hlen, ndl, nlen) ;
+	return p ? p - hay + 1 : 0 ;
+}
+
+// Count the non-overlapping occurrences of a string in a block of memory
+// (SYS "BBC_MemCount", addr%%, size%, needle$, LEN(needle$) TO count%):
+int memcount (const char *hay, int hlen, const char *ndl, int nlen)
+{
+	const char *p, *end = hay + hlen ;
+	int n = 0 ;
+	if ((hlen <= 0) || (nlen <= 0))
+		return 0 ;
+	while ((p = fwdsrch (hay, end - hay, ndl, nlen)) != NULL)
+	    {
+		n++ ;
+		hay = p + nlen ;
+	    }
+	return n ;
+}
+
+// Split a block of memory into fields at each occurrence of a delimiter
+// string, storing the first n fields in a string array:
+// SYS "BBC_SplitString", addr%%, size%, delim$, LEN(delim$), ^a$(0), n% TO c%
+// Returns the total number of fields, which may exceed n.  The source must
+// not be one of the destination strings:
+int strsplit (const char *src, int len, const char *dlm, int dlen, STR *arr, int n)
+{
+	const char *p, *end = src + len ;
+	heapptr *savesp = esp ;
+	int count = 0 ;
+	if ((len < 0) || (dlen <= 0))
+		return 0 ;
+	esp = sysesp ; // needed by allocs
+	do
+	    {
+		p = fwdsrch (src, end - src, dlm, dlen) ;
+		if (p == NULL)
+			p = end ;
+		if (count < n)
+			memcpy (allocs (arr + count, p - src), src, p - src) ;
+		count++ ;
+		src = p + dlen ;
+	    }
+	while (p != end) ;
+	esp = savesp ;
+	return count ;
+}
+
 VAR item (void)
 {
 	VAR v ;
@@ -1413,19 +2000,16 @@ VAR item (void)
 				    }
 				allocs (&tmps, 0) ; // Free tmps (may change pfree)
 				p = pfree + (char *) zero ;
-				while (count--)
+				if (count > 0)
 				    {
-					int eof ;
-					char al = osbget (chan, &eof) ;
-					if (eof) break ;
-					if (term >= 0)
-					    {
-						if (al == (term & 0xFF)) break ;
-						if ((al == 0x0D) && (term & 0x8100)) break ;
-						if ((al == 0x0A) && (term & 0x100)) break ;
-					    }
-					*p++ = al ;
-					if (p > ((char *) esp - STACK_NEEDED))
+					long long room = (char *) esp - STACK_NEEDED - p ;
+					int eof, n, max = count ;
+					if (room < max)
+						max = (room > 0) ? room : 0 ;
+					n = osbgets (chan, p, max, term, &eof) ;
+					p += n ;
+					if ((n == max) && (max < count) && !eof &&
+					    osbgets (chan, p, 1, term, &eof))
 						error (0, NULL) ; // 'No room'
 				    }
 				v.s.t = -1 ;
@@ -1721,6 +2305,8 @@ VAR item (void)
 			v.i.t = 0 ;
 			v.i.n = 0 ;
 			type &= ~BIT6 ;
+			if (arrsum (ptr, count, type, 1, &v))
+				count = 0 ;
 			for (i = 0; i < count; i++)
 			    {
 				VAR x = loadn (ptr, type) ; // n.b. type can be 40
@@ -1765,6 +2351,8 @@ VAR item (void)
 				v.i.t = 0 ;
 				v.i.n = 0 ;
 				type &= ~BIT6 ;
+				if (arrsum (ptr, count, type, 0, &v))
+					count = 0 ;
 				while (count--)
 				    {
 					v = math (v, '+', loadn (ptr, type)) ; // n.b. type can be 40
@@ -1773,28 +2361,13 @@ VAR item (void)
 			    }
 			else if (sumlen)
 			    {
-				int n = 0 ;
-				type &= ~BIT6 ;
-				while (count--)
-				    {
-					x = loads (ptr, type) ;
-					ptr += 8 ;
-					n += x.s.l ;
-				    }
 				v.i.t = 0 ;
-				v.i.n = n ;
+				v.i.n = arrlens (ptr, count, type & ~BIT6) ;
 			    }
 			else
 			    {
-				int i, n = 0 ;
-				void *tmp = ptr ;
+				int n = arrlens (ptr, count, type & ~BIT6) ;
 				type &= ~BIT6 ;
-				for (i = 0 ; i < count; i++)
-				    {
-					x = loads (tmp, type) ;
-					tmp += 8 ;
-					n += x.s.l ;
-				    }
 				v.s.t = -1 ;
 				v.s.l = n ;
 				v.s.p = alloct (n) - (char *) zero ;
@@ -1924,7 +2497,7 @@ VAR item (void)
 			heapptr *oldesp ;
 			v = items () ;
 			fixs (v) ;
-			lexan (accs, accs, 0) ; // assumes string gets no longer
+			evalex (v.s.l, accs) ; // assumes string gets no longer
 			v.s.p = accs - (char *) zero ;
 			v.s.l += 1 ;
 			oldesp = pushs (v) ;
@@ -2162,18 +2735,11 @@ VAR item (void)
 			    }
 			else
 			    {
-				p = x.s.p + n + (char *) zero ;
+				p = (char *) fwdsrch (x.s.p + n + (char *) zero, x.s.l - n,
+							v.s.p + (char *) zero, v.s.l) ;
 				n = 0 ;
-				while (p != NULL)
-				    {
-					if (0 == memcmp (p, v.s.p + zero, v.s.l))
-					    {
-						n = p - (char *) zero - x.s.p + 1 ;
-						break ;
-					    }
-					p = memchr (p + 1, *(v.s.p + (char *) zero),
-							x.s.p + x.s.l - v.s.l + (char *) zero - p) ;
-				    }
+				if (p != NULL)
+					n = p - (char *) zero - x.s.p + 1 ;
 				v.i.t = 0 ;
 				v.i.n = n ;
 				esp = oldesp ;
@@ -2312,7 +2878,7 @@ VAR item (void)
 		default:
 			esi-- ;
 			if (((al >= '0') && (al <= '9')) || (al == '.'))
-				return con() ;
+				return conc () ;
 #if defined (REDUCE_STACK_SIZE) && defined(__GNUC__) && !defined(__llvm__)
 		return nesteddefault();
 		VAR __attribute__ ((noinline)) nesteddefault(void)
@@ -2630,6 +3196,754 @@ VAR expr (void)
 	return x;
 }
 
+// Whole-array arithmetic kernels used by expra().  Each performs
+// dst() = dst() op src() (or op y if src is NULL) on n elements of one type
+// and returns the number done.  They stop at the first element which would
+// cause an error or doesn't hold a plain value, leaving the caller to finish
+// using loadn() and modify() so that results and errors are unchanged.
+
+#if defined __ARM_NEON
+// Test for any lane of two vectors being different:
+static int anyne32 (int32x4_t a, int32x4_t b)
+{
+	uint32x4_t ne = vmvnq_u32 (vceqq_s32 (a, b)) ;
+	uint32x2_t t = vorr_u32 (vget_low_u32 (ne), vget_high_u32 (ne)) ;
+	return vget_lane_u32 (t, 0) | vget_lane_u32 (t, 1) ;
+}
+#endif
+
+// 8-bit (&) array; wraps modulo 256 as storen() does:
+static int arru8 (unsigned char *dst, unsigned char *src, long long y, int n, signed char op)
+{
+	int i = 0 ;
+
+	if (y != (int) y)
+		return 0 ;
+	if (((op == '+') || (op == '-') || (op == '*')) && ((y < -0x800000) || (y > 0x800000)))
+		return 0 ;
+
+	if ((op == '+') || (op == '-') || (op == TAND) || (op == TOR) || (op == TEOR))
+	    {
+#if defined __SSE2__
+		__m128i b = _mm_set1_epi8 (y) ;
+		for ( ; i <= n - 16; i += 16)
+		    {
+			__m128i a = _mm_loadu_si128 ((__m128i *)(dst + i)) ;
+			if (src)
+				b = _mm_loadu_si128 ((__m128i *)(src + i)) ;
+			switch (op)
+			    {
+				case '+':  a = _mm_add_epi8 (a, b) ; break ;
+				case '-':  a = _mm_sub_epi8 (a, b) ; break ;
+				case TAND: a = _mm_and_si128 (a, b) ; break ;
+				case TOR:  a = _mm_or_si128 (a, b) ; break ;
+				case TEOR: a = _mm_xor_si128 (a, b) ; break ;
+			    }
+			_mm_storeu_si128 ((__m128i *)(dst + i), a) ;
+		    }
+#elif defined __ARM_NEON
+		uint8x16_t b = vdupq_n_u8 (y) ;
+		for ( ; i <= n - 16; i += 16)
+		    {
+			uint8x16_t a = vld1q_u8 (dst + i) ;
+			if (src)
+				b = vld1q_u8 (src + i) ;
+			switch (op)
+			    {
+				case '+':  a = vaddq_u8 (a, b) ; break ;
+				case '-':  a = vsubq_u8 (a, b) ; break ;
+				case TAND: a = vandq_u8 (a, b) ; break ;
+				case TOR:  a = vorrq_u8 (a, b) ; break ;
+				case TEOR: a = veorq_u8 (a, b) ; break ;
+			    }
+			vst1q_u8 (dst + i, a) ;
+		    }
+#endif
+	    }
+
+	for ( ; i < n; i++)
+	    {
+		int x = dst[i], r ;
+		if (src)
+			y = src[i] ;
+		switch (op)
+		    {
+			case '=':  r = y ; break ;
+			case '+':  r = x + y ; break ;
+			case '-':  r = x - y ; break ;
+			case '*':  r = x * y ; break ;
+			case TAND: r = x & y ; break ;
+			case TOR:  r = x | y ; break ;
+			case TEOR: r = x ^ y ; break ;
+			case '/':
+				if (y == 0)
+					return i ;
+				r = (REAL) x / (REAL) y ;
+				break ;
+			case TDIV:
+				if (y == 0)
+					return i ;
+				r = x / y ;
+				break ;
+			case TMOD:
+				if (y == 0)
+					return i ;
+				r = x % y ;
+				break ;
+			default:
+				return i ;
+		    }
+		dst[i] = r ;
+	    }
+	return n ;
+}
+
+// 32-bit (%) array; any result which doesn't fit is left to the caller:
+static int arri32 (char *dst, char *src, long long y, int n, signed char op)
+{
+	int i = 0 ;
+
+	if (y != (int) y)
+		return 0 ;
+
+	if ((op == '+') || (op == '-') || (op == TAND) || (op == TOR) || (op == TEOR))
+	    {
+#if defined __SSE2__
+		__m128i b = _mm_set1_epi32 (y) ;
+		for ( ; i <= n - 4; i += 4)
+		    {
+			__m128i a = _mm_loadu_si128 ((__m128i *)(dst + i * 4)) ;
+			__m128i r, v = _mm_setzero_si128 () ;
+			if (src)
+				b = _mm_loadu_si128 ((__m128i *)(src + i * 4)) ;
+			switch (op)
+			    {
+				case '+':
+					r = _mm_add_epi32 (a, b) ;
+					v = _mm_and_si128 (_mm_xor_si128 (a, r), _mm_xor_si128 (b, r)) ;
+					break ;
+				case '-':
+					r = _mm_sub_epi32 (a, b) ;
+					v = _mm_and_si128 (_mm_xor_si128 (a, b), _mm_xor_si128 (a, r)) ;
+					break ;
+				case TAND: r = _mm_and_si128 (a, b) ; break ;
+				case TOR:  r = _mm_or_si128 (a, b) ; break ;
+				default:   r = _mm_xor_si128 (a, b) ; break ;
+			    }
+			if (_mm_movemask_ps (_mm_castsi128_ps (v)))
+				break ; // overflow
+			_mm_storeu_si128 ((__m128i *)(dst + i * 4), r) ;
+		    }
+#elif defined __ARM_NEON
+		int32x4_t b = vdupq_n_s32 (y) ;
+		for ( ; i <= n - 4; i += 4)
+		    {
+			int32x4_t a = vld1q_s32 ((int32_t *)(dst + i * 4)) ;
+			int32x4_t r ;
+			if (src)
+				b = vld1q_s32 ((int32_t *)(src + i * 4)) ;
+			switch (op)
+			    {
+				case '+':
+					r = vaddq_s32 (a, b) ;
+					if (anyne32 (r, vqaddq_s32 (a, b)))
+						goto done ; // overflow
+					break ;
+				case '-':
+					r = vsubq_s32 (a, b) ;
+					if (anyne32 (r, vqsubq_s32 (a, b)))
+						goto done ; // overflow
+					break ;
+				case TAND: r = vandq_s32 (a, b) ; break ;
+				case TOR:  r = vorrq_s32 (a, b) ; break ;
+				default:   r = veorq_s32 (a, b) ; break ;
+			    }
+			vst1q_s32 ((int32_t *)(dst + i * 4), r) ;
+		    }
+		done: ;
+#endif
+	    }
+
+	for ( ; i < n; i++)
+	    {
+		long long x = ILOAD(dst + i * 4), r ;
+		if (src)
+			y = ILOAD(src + i * 4) ;
+		switch (op)
+		    {
+			case '=':  r = y ; break ;
+			case '+':  r = x + y ; break ;
+			case '-':  r = x - y ; break ;
+			case '*':  r = x * y ; break ;
+			case TAND: r = x & y ; break ;
+			case TOR:  r = x | y ; break ;
+			case TEOR: r = x ^ y ; break ;
+			case '/':
+				if (y == 0)
+					return i ;
+				r = (REAL) x / (REAL) y ;
+				break ;
+			case TDIV:
+				if (y == 0)
+					return i ;
+				r = x / y ;
+				break ;
+			case TMOD:
+				if (y == 0)
+					return i ;
+				r = x % y ;
+				break ;
+			default:
+				return i ;
+		    }
+		if (r != (int) r)
+			return i ;
+		ISTORE(dst + i * 4, r) ;
+	    }
+	return n ;
+}
+
+// 64-bit (%%) array; integer overflow is left to the caller:
+static int arri64 (char *dst, char *src, long long y, int n, signed char op)
+{
+	int i = 0 ;
+
+	if ((op == '+') || (op == '-') || (op == TAND) || (op == TOR) || (op == TEOR))
+	    {
+#if defined __SSE2__
+		__m128i b = _mm_set1_epi64x (y) ;
+		for ( ; i <= n - 2; i += 2)
+		    {
+			__m128i a = _mm_loadu_si128 ((__m128i *)(dst + i * 8)) ;
+			__m128i r, v = _mm_setzero_si128 () ;
+			if (src)
+				b = _mm_loadu_si128 ((__m128i *)(src + i * 8)) ;
+			switch (op)
+			    {
+				case '+':
+					r = _mm_add_epi64 (a, b) ;
+					v = _mm_and_si128 (_mm_xor_si128 (a, r), _mm_xor_si128 (b, r)) ;
+					break ;
+				case '-':
+					r = _mm_sub_epi64 (a, b) ;
+					v = _mm_and_si128 (_mm_xor_si128 (a, b), _mm_xor_si128 (a, r)) ;
+					break ;
+				case TAND: r = _mm_and_si128 (a, b) ; break ;
+				case TOR:  r = _mm_or_si128 (a, b) ; break ;
+				default:   r = _mm_xor_si128 (a, b) ; break ;
+			    }
+			if (_mm_movemask_pd (_mm_castsi128_pd (v)))
+				break ; // overflow
+			_mm_storeu_si128 ((__m128i *)(dst + i * 8), r) ;
+		    }
+#elif defined __ARM_NEON
+		int64x2_t b = vdupq_n_s64 (y) ;
+		for ( ; i <= n - 2; i += 2)
+		    {
+			int64x2_t a = vld1q_s64 ((int64_t *)(dst + i * 8)) ;
+			int64x2_t r ;
+			if (src)
+				b = vld1q_s64 ((int64_t *)(src + i * 8)) ;
+			switch (op)
+			    {
+				case '+':
+					r = vaddq_s64 (a, b) ;
+					if (anyne32 (vreinterpretq_s32_s64 (r),
+						     vreinterpretq_s32_s64 (vqaddq_s64 (a, b))))
+						goto done ; // overflow
+					break ;
+				case '-':
+					r = vsubq_s64 (a, b) ;
+					if (anyne32 (vreinterpretq_s32_s64 (r),
+						     vreinterpretq_s32_s64 (vqsubq_s64 (a, b))))
+						goto done ; // overflow
+					break ;
+				case TAND: r = vandq_s64 (a, b) ; break ;
+				case TOR:  r = vorrq_s64 (a, b) ; break ;
+				default:   r = veorq_s64 (a, b) ; break ;
+			    }
+			vst1q_s64 ((int64_t *)(dst + i * 8), r) ;
+		    }
+		done: ;
+#endif
+	    }
+
+	for ( ; i < n; i++)
+	    {
+		long long x, r ;
+		memcpy (&x, dst + i * 8, 8) ;
+		if (src)
+			memcpy (&y, src + i * 8, 8) ;
+		switch (op)
+		    {
+			case '=':
+				r = y ;
+				break ;
+			case '+':
+				r = (unsigned long long) x + y ;
+				if (((x ^ r) & (y ^ r)) < 0)
+					return i ;
+				break ;
+			case '-':
+				r = (unsigned long long) x - y ;
+				if (((x ^ y) & (x ^ r)) < 0)
+					return i ;
+				break ;
+			case '*':
+#if defined __GNUC__ && __GNUC__ < 5
+				if ((x != (int) x) || (y != (int) y))
+					return i ;
+				r = x * y ;
+#else
+				if (__builtin_smulll_overflow (x, y, &r))
+					return i ;
+#endif
+				break ;
+			case TAND: r = x & y ; break ;
+			case TOR:  r = x | y ; break ;
+			case TEOR: r = x ^ y ; break ;
+			case TDIV:
+				if ((y == 0) || ((y == -1) && (x == (long long) 0x8000000000000000)))
+					return i ;
+				r = x / y ;
+				break ;
+			case TMOD:
+				if ((y == 0) || ((y == -1) && (x == (long long) 0x8000000000000000)))
+					return i ;
+				r = x % y ;
+				break ;
+			default:
+				return i ;
+		    }
+		memcpy (dst + i * 8, &r, 8) ;
+	    }
+	return n ;
+}
+
+// 64-bit float (#) array.  A value whose MS word is zero is loaded by loadn()
+// as an integer so only +0.0 (as integer zero) is accepted in that form; the
+// special cases of math() and storen() for zero are followed exactly:
+static int arrf64 (char *dst, char *src, VAR v, int n, signed char op)
+{
+	int i = 0 ;
+	REAL y = 0 ;
+	int yzero = 0 ;
+
+	if ((op != '=') && (op != '+') && (op != '-') && (op != '*') && (op != '/'))
+		return 0 ;
+	if (src == NULL)
+	    {
+		if (v.i.t == 0)
+		    {
+			y = v.i.n ;
+			yzero = (v.i.n == 0) ;
+		    }
+		else
+		    {
+			y = v.f ;
+#if defined __arm__ || defined __aarch64__ || defined __EMSCRIPTEN__ || defined __ANDROID__ || defined __riscv__
+			yzero = (v.i.n == 0) ;
+#else
+			yzero = (v.f == 0) ;
+#endif
+		    }
+	    }
+	setfpu () ;
+
+#if defined __aarch64__
+	if ((op != '=') && !(yzero && (src == NULL)))
+	    {
+		// No zero or integer-format operands (MS word zero) and no zero,
+		// infinite or NaN results, so no special cases apply:
+		float64x2_t b = vdupq_n_f64 (y) ;
+		uint64x2_t ms = vdupq_n_u64 (0xFFFFFFFF00000000) ;
+		uint64x2_t inf = vdupq_n_u64 (0x7FF0000000000000) ;
+		for ( ; i <= n - 2; i += 2)
+		    {
+			float64x2_t a = vld1q_f64 ((double *)(dst + i * 8)) ;
+			float64x2_t r ;
+			uint64x2_t bad ;
+			if (src)
+				b = vld1q_f64 ((double *)(src + i * 8)) ;
+			switch (op)
+			    {
+				case '+': r = vaddq_f64 (a, b) ; break ;
+				case '-': r = vsubq_f64 (a, b) ; break ;
+				case '*': r = vmulq_f64 (a, b) ; break ;
+				default:  r = vdivq_f64 (a, b) ; break ;
+			    }
+			bad = vceqq_u64 (vandq_u64 (vreinterpretq_u64_f64 (a), ms), vdupq_n_u64 (0)) ;
+			bad = vorrq_u64 (bad, vceqq_u64 (vandq_u64 (vreinterpretq_u64_f64 (b), ms),
+						      vdupq_n_u64 (0))) ;
+			bad = vorrq_u64 (bad, vceqq_u64 (vandq_u64 (vreinterpretq_u64_f64 (r), ms),
+						      vdupq_n_u64 (0))) ;
+			bad = vorrq_u64 (bad, vcgeq_u64 (vandq_u64 (vreinterpretq_u64_f64 (r),
+						      vdupq_n_u64 (0x7FFFFFFFFFFFFFFF)), inf)) ;
+			if (vmaxvq_u32 (vreinterpretq_u32_u64 (bad)))
+				break ;
+			vst1q_f64 ((double *)(dst + i * 8), r) ;
+		    }
+	    }
+#endif
+
+	for ( ; i < n; i++)
+	    {
+		unsigned long long a, b ;
+		REAL x, r ;
+		double d ;
+		int xzero ;
+
+		memcpy (&a, dst + i * 8, 8) ;
+		if ((a >> 32) == 0)
+		    {
+			if (a)
+				return i ; // integer in float array
+			x = 0 ;
+			xzero = 1 ;
+		    }
+		else
+		    {
+			memcpy (&d, &a, 8) ;
+			x = d ;
+#if defined __arm__ || defined __aarch64__ || defined __EMSCRIPTEN__ || defined __ANDROID__ || defined __riscv__
+			xzero = 0 ;
+#else
+			xzero = (x == 0) ;
+#endif
+		    }
+
+		if (src)
+		    {
+			memcpy (&b, src + i * 8, 8) ;
+			if ((b >> 32) == 0)
+			    {
+				if (b)
+					return i ; // integer in float array
+				y = 0 ;
+				yzero = 1 ;
+			    }
+			else
+			    {
+				memcpy (&d, &b, 8) ;
+				y = d ;
+#if defined __arm__ || defined __aarch64__ || defined __EMSCRIPTEN__ || defined __ANDROID__ || defined __riscv__
+				yzero = 0 ;
+#else
+				yzero = (y == 0) ;
+#endif
+			    }
+		    }
+
+		switch (op)
+		    {
+			case '=':
+				r = y ;
+				break ;
+			case '+':
+				r = x + y ;
+				break ;
+			case '-':
+				r = x - y ;
+				break ;
+			case '*':
+				if (xzero)
+					r = x ;
+				else if (yzero)
+					r = y ;
+				else
+					r = x * y ;
+				break ;
+			default:
+				r = x / y ;
+				break ;
+		    }
+		if (isinf (r) || isnan (r))
+			return i ;
+#if !(defined __arm__ || defined __aarch64__ || defined __EMSCRIPTEN__ || defined __ANDROID__ || defined __riscv__)
+		if ((r == 0) && (op != '=') && ((op != '*') || !(xzero || yzero)))
+			r = 0 ; // math() discards the sign of a zero result
+#endif
+		d = r ;
+		if (isinf (d))
+			return i ;
+		memcpy (&a, &d, 8) ;
+		if ((a >> 32) == 0)
+			a = 0 ;
+		memcpy (dst + i * 8, &a, 8) ;
+	    }
+	return n ;
+}
+
+// Select the kernel for an array type (returns 0 if there isn't one):
+static int arrop (void *dst, void *src, VAR v, int n, unsigned char type, signed char op)
+{
+	long long y = 0 ;
+
+	if (type != 8)
+	    {
+		if ((src == NULL) && (v.i.t != 0))
+		    {
+			// Non-integer scalar: only the bitwise and integer division
+			// operators convert it to an integer, the same way as fix2():
+			long long t = v.f ;
+			if (((op != TAND) && (op != TOR) && (op != TEOR) &&
+			     (op != TDIV) && (op != TMOD)) || (t != truncl (v.f)))
+				return 0 ;
+			v.i.n = t ;
+		    }
+		y = v.i.n ;
+	    }
+
+	switch (type)
+	    {
+		case 1:
+			return arru8 (dst, src, y, n, op) ;
+		case 4:
+			return arri32 (dst, src, y, n, op) ;
+		case 8:
+			return arrf64 (dst, src, v, n, op) ;
+		case 40:
+			return arri64 (dst, src, y, n, op) ;
+	    }
+	return 0 ;
+}
+
+// Matrix product for the array dot operator: c(m,n) += a(m,p) . b(p,n)
+// Each element is accumulated in the same order (k = 0 to p-1) as by the
+// generic loadn/math/modify loop, but tiles of 4 x 4 results are kept in
+// SIMD registers (GCC vector extension) and B is packed into panels 4
+// columns wide.  Integer products and sums are checked for overflow, in
+// which case nothing is stored and the generic code reports the error.
+
+typedef struct
+{
+	void *a ;	// m x p, row-major
+	void *b ;	// p x n, packed into panels of 4 columns (float) or row-major
+	void *c ;	// m x n, row-major
+	int i0, i1 ;	// rows of c to compute
+	int m, n, p ;
+	volatile int *fail ;
+} gemmarg ;
+
+static void *dgemm (void *arg)
+{
+	gemmarg *g = arg ;
+	double *a = g->a, *bp = g->b, *c = g->c ;
+	int i, j, k, kb, r, q, n = g->n, p = g->p ;
+
+	for (kb = 0; kb < p; kb += GEMMKB)
+	    {
+		int ke = (p - kb) < GEMMKB ? p : kb + GEMMKB ;
+		for (j = 0; j < n; j += 4)
+		    {
+			double *b = bp + (size_t) j * p ; // panel j / 4
+			int jw = (n - j) < 4 ? n - j : 4 ;
+			for (i = g->i0; i < g->i1; i += 4)
+			    {
+				double t[4][4] __attribute__ ((aligned (16))) = {{0}} ;
+				double *ar[4] ;
+				v2df c0[4], c1[4] ;
+				int rows = (g->i1 - i) < 4 ? g->i1 - i : 4 ;
+
+				for (r = 0; r < 4; r++)
+				    {
+					ar[r] = a + (size_t)(i + (r < rows ? r : 0)) * p ;
+					if (r < rows)
+						for (q = 0; q < jw; q++)
+							t[r][q] = c[(size_t)(i + r) * n + j + q] ;
+					c0[r] = *(v2df *) &t[r][0] ;
+					c1[r] = *(v2df *) &t[r][2] ;
+				    }
+
+				for (k = kb; k < ke; k++)
+				    {
+					v2df b0 = *(v2df *)(b + k * 4) ;
+					v2df b1 = *(v2df *)(b + k * 4 + 2) ;
+					for (r = 0; r < 4; r++)
+					    {
+						v2df av = {ar[r][k], ar[r][k]} ;
+						c0[r] += av * b0 ;
+						c1[r] += av * b1 ;
+					    }
+				    }
+
+				for (r = 0; r < rows; r++)
+				    {
+					*(v2df *) &t[r][0] = c0[r] ;
+					*(v2df *) &t[r][2] = c1[r] ;
+					for (q = 0; q < jw; q++)
+						c[(size_t)(i + r) * n + j + q] = t[r][q] ;
+				    }
+			    }
+		    }
+	    }
+	return NULL ;
+}
+
+// Integer multiply-accumulate, returning non-zero on overflow:
+static inline int lmac (long long *acc, long long x, long long y)
+{
+	long long prod, sum ;
+#if defined __GNUC__ && __GNUC__ < 5
+	if ((x != (int) x) || (y != (int) y))
+		return 1 ; // (conservative)
+	prod = x * y ;
+	sum = (unsigned long long) *acc + prod ;
+	if (((*acc ^ sum) & (prod ^ sum)) < 0)
+		return 1 ;
+#else
+	if (__builtin_smulll_overflow (x, y, &prod) ||
+	    __builtin_saddll_overflow (*acc, prod, &sum))
+		return 1 ;
+#endif
+	*acc = sum ;
+	return 0 ;
+}
+
+static void *lgemm (void *arg)
+{
+	gemmarg *g = arg ;
+	long long *a = g->a, *b = g->b, *c = g->c ;
+	int i, j, k, kb, n = g->n, p = g->p ;
+
+	for (i = g->i0; (i < g->i1) && !*g->fail; i++)
+	    {
+		long long *cr = c + (size_t) i * n ;
+		for (kb = 0; kb < p; kb += GEMMKB)
+		    {
+			int ke = (p - kb) < GEMMKB ? p : kb + GEMMKB ;
+			for (k = kb; k < ke; k++)
+			    {
+				long long x = a[(size_t) i * p + k], *br = b + (size_t) k * n ;
+				if (x == 0)
+					continue ;
+				for (j = 0; j < n; j++)
+				    {
+					if (lmac (cr + j, x, br[j]))
+					    {
+						*g->fail = 1 ;
+						return NULL ;
+					    }
+				    }
+			    }
+		    }
+	    }
+	return NULL ;
+}
+
+// Multiply matrices of 64-bit floats (type 8) or integers (type 40),
+// returning zero (with ebp unchanged) if the generic code must be used:
+static int gemm (void *ebp, void *ptr, void *rhs, int m, int n, int p, unsigned char type)
+{
+	gemmarg g[4] ;
+	void *(*work) (void *) = (type == 8) ? dgemm : lgemm ;
+	volatile int fail = 0 ;
+	void *a, *b, *c ;
+	int i, j, k, nthreads = 1 ;
+	size_t np = (n + 3) & -4 ; // columns of B rounded up to a whole panel
+
+	if (((type != 8) && (type != 40)) || (m <= 0) || (n <= 0) || (p <= 0))
+		return 0 ;
+
+	a = malloc ((size_t) m * p * 8) ;
+	b = malloc ((size_t) p * np * 8) ;
+	c = malloc ((size_t) m * n * 8) ;
+	if ((a == NULL) || (b == NULL) || (c == NULL))
+	    {
+		free (a) ; free (b) ; free (c) ;
+		return 0 ;
+	    }
+
+	memcpy (a, ptr, (size_t) m * p * 8) ;
+	memcpy (c, ebp, (size_t) m * n * 8) ;
+	if (type == 8)
+	    {
+		// Values with a zero MS word are integers (except +0.0):
+		unsigned int *w = a ;
+		for (i = 0; i < m * p; i++, w += 2)
+			if ((w[1] == 0) && (w[0] != 0))
+				fail = 1 ;
+		w = c ;
+		for (i = 0; i < m * n; i++, w += 2)
+			if ((w[1] == 0) && (w[0] != 0))
+				fail = 1 ;
+		for (k = 0; k < p; k++)
+			for (j = 0; j < (int) np; j++)
+			    {
+				double *d = (double *) b + ((size_t)(j >> 2) * p + k) * 4 + (j & 3) ;
+				if (j < n)
+				    {
+					memcpy (d, (char *) rhs + ((size_t) k * n + j) * 8, 8) ;
+					if ((((unsigned int *) d)[1] == 0) && (((unsigned int *) d)[0] != 0))
+						fail = 1 ;
+				    }
+				else
+					*d = 0.0 ;
+			    }
+	    }
+	else
+		memcpy (b, rhs, (size_t) p * n * 8) ;
+
+	if (fail)
+	    {
+		free (a) ; free (b) ; free (c) ;
+		return 0 ;
+	    }
+
+#ifdef GEMM_THREADS
+	if (((double) m * n * p >= MTGEMM) && (m >= 8))
+		nthreads = 4 ;
+#endif
+	for (i = 0; i < nthreads; i++)
+	    {
+		g[i].a = a ;
+		g[i].b = b ;
+		g[i].c = c ;
+		g[i].m = m ;
+		g[i].n = n ;
+		g[i].p = p ;
+		g[i].fail = &fail ;
+		g[i].i0 = (int)((long long) m * i / nthreads) & -4 ;
+		g[i].i1 = (i == nthreads - 1) ? m : (int)((long long) m * (i + 1) / nthreads) & -4 ;
+	    }
+
+#ifdef GEMM_THREADS
+	{
+	pthread_t thread[4] ;
+	int started[4] = {0} ;
+	for (i = 1; i < nthreads; i++)
+		started[i] = (pthread_create (&thread[i], NULL, work, &g[i]) == 0) ;
+	for (i = 0; i < nthreads; i++)
+		if ((i == 0) || !started[i])
+			work (&g[i]) ;
+	for (i = 1; i < nthreads; i++)
+		if (started[i])
+			pthread_join (thread[i], NULL) ;
+	}
+#else
+	work (&g[0]) ;
+#endif
+
+	if (type == 8)
+	    {
+		// Overflow is reported by the generic code; tiny results are
+		// stored as zero, as by storen():
+		double *d = c ;
+		for (i = 0; i < m * n; i++)
+		    {
+			if (isinf (d[i]) || isnan (d[i]))
+				fail = 1 ;
+			else if (((unsigned int *)(d + i))[1] == 0)
+				d[i] = 0.0 ;
+		    }
+	    }
+
+	if (!fail)
+		memcpy (ebp, c, (size_t) m * n * 8) ;
+	free (a) ; free (b) ; free (c) ;
+	return !fail ;
+}
+
 // Evaluate an array expression (strictly left-to-right):
 int expra (void *ebp, int ecx, unsigned char type)
 {
@@ -2645,7 +3959,7 @@ int expra (void *ebp, int ecx, unsigned char type)
 		esi++ ;
 		VAR v = items () ;
 		fixs (v) ;
-		lexan (accs, buff, 0) ;
+		evalex (v.s.l, buff) ;
 		tmpesi = esi ;
 		esi = (signed char *) buff ;
 		count = expra (ebp, ecx, type) ; // recursive call
@@ -2683,7 +3997,13 @@ int expra (void *ebp, int ecx, unsigned char type)
 					error (6, NULL) ; // 'Type mismatch'
 				if (type < 128) // numeric array
 				    {
-					for (i = 0; i < ecx; i++)
+					VAR v ;
+					v.i.t = 0 ;
+					v.i.n = 0 ;
+					i = arrop (ebp, ptr, v, ecx, type & ~BIT6, op) ;
+					ebp += i * (type & TMASK) ; // GCC extension
+					ptr += i * (type & TMASK) ; // GCC extension
+					for ( ; i < ecx; i++)
 					    {
 						VAR v = loadn (ptr, type & ~BIT6) ;
 						modify (v, ebp, type & ~BIT6, op) ;
@@ -2728,7 +4048,13 @@ int expra (void *ebp, int ecx, unsigned char type)
 					if (v.s.t == -1)
 						error (6, NULL) ; // 'Type mismatch'
 
-					for (i = 0; i < ecx; i++)
+					i = 0 ;
+					if (nxt () != ',') // not a list of initialisers
+					    {
+						i = arrop (ebp, NULL, v, ecx, type & ~BIT6, op) ;
+						ebp += i * (type & TMASK) ; // GCC extension
+					    }
+					for ( ; i < ecx; i++)
 					    {
 						modify (v, ebp, type & ~BIT6, op) ;
 						ebp += type & TMASK ; // GCC extension
@@ -2828,6 +4154,8 @@ int expra (void *ebp, int ecx, unsigned char type)
 
 		type &= ~BIT6 ;
 		size = type & TMASK ;
+		if (gemm (ebp, ptr, rhs, rowsl, colsr, colsl, type))
+			return ecx ;
 		for (i = 0; i < rowsl; i++)
 		    {
 			void *oldrhs = rhs ;
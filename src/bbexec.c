@@ -11,14 +11,18 @@
 
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdint.h>
 #include <math.h>
+#include <time.h>
 #include "BBC.h"
 
 #if defined __riscv__
 #define truncl trunc
 #endif
 
+#define FORINT 0x100	// FOR frame flag: integer variable, limit and step
+
 // Routines in bbmain:
 int range1 (char) ;		// Test char for valid in a variable name
 signed char nxt (void) ;	// Skip spaces, handle line continuation
@@ -35,6 +39,7 @@ char *moves (STR *, int) ;	// Move string into temporary buffer
 void braket (void) ;		// Check for closing parenthesis
 void comma (void) ;		// Check for a comma
 void clear (void) ;		// Clear dynamic variables etc.
+void clrhash (void) ;		// Discard hashed variable index
 void clrtrp (void) ;		// Clear ON event handlers
 signed char *findl (unsigned int) ;	// Find a specified line number or label
 int arrlen (void **) ;		// Count elements in an array
@@ -77,6 +82,7 @@ void mouseon (int) ;		// Set mouse cursor (pointer)
 void mouseoff (void) ;		// Hide mouse cursor
 void mouseto (int, int) ;	// Move mouse cursor
 void *sysadr (char *) ;		// Get the address of an API function
+void *sysfind (void) ;		// Get the address of SYS "name" (cached)
 size_t guicall (void *, PARM *) ;	// Call function in GUI thread context
 heapptr oshwm (void *, int) ;	// Allocate memory above HIMEM
 int oscall (int) ;		// Call an emulated OS function
@@ -85,6 +91,7 @@ void quiet (void) ;		// Disable sound generation
 void sound (short, signed char, unsigned char, unsigned char) ; // SOUND statement
 void *osopen (int, char *) ;	// Open a file
 unsigned char osbget (void *, int*) ; // Read a byte from a file
+int osbgets (void *, char *, int, int, int*) ; // Read a line from a file
 void osbput (void *, unsigned char) ; // Write a byte to a file
 void setptr (void *, long long) ;	// Set the file pointer
 long long getext (void *) ;	// Get file length
@@ -104,6 +111,9 @@ void oscli (char*) ;		// OSCLI
 long long apicall_ (void *, PARM *) ;
 double fltcall_ (void *, PARM *) ;
 
+// Stack pointer for interpreter functions called using SYS:
+extern heapptr *sysesp ;
+
 void spaces (int num)
 {
 	while (num-- > 0)
@@ -1106,6 +1116,174 @@ static void defscan (signed char *edx)
 	    }
 }
 
+// Profiler (*PROFILE ON): per-line hit counts are gathered in newlin(),
+// FN/PROC call counts and inclusive times in procfn() and on return.
+// A call is identified by the address of its FNCHK/PROCHK marker on the
+// BASIC stack, so calls abandoned because of an error are discarded.
+unsigned char profon ;		// Non-zero whilst profiling
+
+typedef struct { heapptr addr ; unsigned int hits ; } PROFLINE ;
+typedef struct { heapptr addr ; unsigned int calls ; clock_t time ; char name[32] ; } PROFDEF ;
+
+static PROFLINE *proflin ;	// Hash table of lines, keyed by address
+static PROFDEF *profdef ;	// Hash table of FNs/PROCs, keyed by body address
+static int plsize, plused, pdsize, pdused ;
+static struct { heapptr *mark ; PROFDEF *def ; clock_t start ; } profstk[256] ;
+static int profsp ;
+
+// Find or add an entry in a profiler hash table (growing it as necessary):
+static void *proffind (void **ptable, int *psize, int *pused, int esize, heapptr addr)
+{
+	char *table = *ptable ;
+	unsigned int h, i ;
+
+	if (*pused >= *psize / 4 * 3)
+	    {
+		char *old = table ;
+		int j, oldsize = *psize, newsize = oldsize ? oldsize * 2 : 1024 ;
+		table = calloc (newsize, esize) ;
+		if (table == NULL)
+		    {
+			profon = 0 ; // out of memory
+			return NULL ;
+		    }
+		for (j = 0; j < oldsize; j++)
+		    {
+			heapptr key = *(heapptr *)(old + j * esize) ;
+			if (key == 0)
+				continue ;
+			h = key * 2654435761U ;
+			for (i = (h ^ (h >> 16)) & (newsize - 1) ; *(heapptr *)(table + i * esize) ;
+				i = (i + 1) & (newsize - 1)) ;
+			memcpy (table + i * esize, old + j * esize, esize) ;
+		    }
+		free (old) ;
+		*ptable = table ;
+		*psize = newsize ;
+	    }
+
+	h = addr * 2654435761U ;
+	for (i = (h ^ (h >> 16)) & (*psize - 1) ; *(heapptr *)(table + i * esize) != addr ;
+		i = (i + 1) & (*psize - 1))
+	    {
+		if (*(heapptr *)(table + i * esize) == 0)
+		    {
+			*(heapptr *)(table + i * esize) = addr ;
+			(*pused)++ ;
+			break ;
+		    }
+	    }
+	return table + i * esize ;
+}
+
+// Start (resetting all counts) or stop profiling:
+void profile (int on)
+{
+	if (on)
+	    {
+		free (proflin) ;
+		free (profdef) ;
+		proflin = NULL ;
+		profdef = NULL ;
+		plsize = plused = pdsize = pdused = 0 ;
+		profsp = 0 ;
+	    }
+	profon = on ;
+}
+
+static void profline (void)
+{
+	PROFLINE *p = proffind ((void **) &proflin, &plsize, &plused, sizeof(PROFLINE), curlin) ;
+	if (p)
+		p->hits++ ;
+}
+
+// Pop the innermost profiled call, adding its time unless it was recursive:
+static void profpop (clock_t now)
+{
+	int i ;
+	PROFDEF *def = profstk[--profsp].def ;
+	for (i = 0; i < profsp; i++)
+		if (profstk[i].def == def)
+			return ;
+	def->time += now - profstk[profsp].start ;
+}
+
+static void profcall (heapptr *mark, signed char *body, signed char *name)
+{
+	PROFDEF *p ;
+	clock_t now = clock () ;
+	while (profsp && (profstk[profsp - 1].mark <= mark))
+		profpop (now) ; // abandoned
+	p = proffind ((void **) &profdef, &pdsize, &pdused, sizeof(PROFDEF), body - (signed char *) zero) ;
+	if (p == NULL)
+		return ;
+	if (p->calls++ == 0)
+	    {
+		int n = (*name == TFN) ? 2 : 4 ;
+		memcpy (p->name, (*name == TFN) ? "FN" : "PROC", n) ;
+		name++ ;
+		while ((n < sizeof(p->name) - 1) && range1 (*name))
+			p->name[n++] = *name++ ;
+		p->name[n] = 0 ;
+	    }
+	if (profsp < sizeof(profstk) / sizeof(profstk[0]))
+	    {
+		profstk[profsp].mark = mark ;
+		profstk[profsp].def = p ;
+		profstk[profsp++].start = now ;
+	    }
+}
+
+static void profret (heapptr *mark)
+{
+	clock_t now = clock () ;
+	while (profsp && (profstk[profsp - 1].mark < mark))
+		profpop (now) ; // abandoned
+	if (profsp && (profstk[profsp - 1].mark == mark))
+		profpop (now) ;
+}
+
+static int cmphits (const void *a, const void *b)
+{
+	return (((PROFLINE *)a)->hits < ((PROFLINE *)b)->hits) -
+	       (((PROFLINE *)a)->hits > ((PROFLINE *)b)->hits) ;
+}
+
+static int cmptime (const void *a, const void *b)
+{
+	return (((PROFDEF *)a)->time < ((PROFDEF *)b)->time) -
+	       (((PROFDEF *)a)->time > ((PROFDEF *)b)->time) ;
+}
+
+// Write the profile, most frequently executed lines and most expensive
+// FNs/PROCs first, returning zero if the file couldn't be created:
+int profsave (const char *path)
+{
+	int i ;
+	FILE *file = fopen (path, "w") ;
+	if (file == NULL)
+		return 0 ;
+
+	if (proflin)
+		qsort (proflin, plsize, sizeof(PROFLINE), cmphits) ;
+	fprintf (file, "  Line        Hits\r\n") ;
+	for (i = 0; (i < plsize) && proflin[i].addr; i++)
+		fprintf (file, "%6u %11u\r\n", SLOAD(proflin[i].addr - 2 + (char *) zero),
+			 proflin[i].hits) ;
+
+	if (profdef)
+		qsort (profdef, pdsize, sizeof(PROFDEF), cmptime) ;
+	fprintf (file, "\r\nFN/PROC                              Calls   Time (ms)\r\n") ;
+	for (i = 0; (i < pdsize) && profdef[i].addr; i++)
+		fprintf (file, "%-32s %9u %11.1f\r\n", profdef[i].name, profdef[i].calls,
+			 profdef[i].time * 1000.0 / CLOCKS_PER_SEC) ;
+
+	// The tables are no longer hashed, so start afresh:
+	profile (profon) ;
+	return fclose (file) == 0 ;
+}
+
 // User-defined PROC, ON PROC and FN:
 void procfn (signed char flag)
 {
@@ -1115,9 +1293,11 @@ void procfn (signed char flag)
 	signed char *oldesi ;
 	heapptr *edi ;
 	heapptr *resesp ;
+	signed char *name ;
 
 	esi-- ;		// Point to TFN or TPROC token
 	oldesi = esi ;
+	name = esi ;
 	ptr = getdef (&found) ;
 	if (ptr == NULL)
 		error (16, NULL) ; // 'Syntax error'
@@ -1141,6 +1321,8 @@ void procfn (signed char flag)
 	else
 		*--esp = PROCHK ;
 	check () ;
+	if (profon)
+		profcall (esp, ebx, name) ;
 
 	if (nxt () == '(')
 	    {
@@ -1222,6 +1404,8 @@ void newlin (void)
 	if (al == 0) return ;
 	esi += 3 ;
 	curlin = esi - (signed char *) zero ;
+	if (profon)
+		profline () ;
 	if (tracen)
 	    {
 		unsigned short lino = SLOAD(esi - 2) ;
@@ -1573,6 +1757,8 @@ VAR xeq (void)
 					else
 						error (13, NULL) ; // 'Not in a procedure'
 				    }
+				if (profon)
+					profret (esp) ;
 				esp++ ;
 				esi = *(void **)esp ;
 				esp += STRIDE ;
@@ -1613,6 +1799,8 @@ VAR xeq (void)
 					else
 						error (7, NULL) ; // 'Not in a function'
 				    }
+				if (profon)
+					profret (esp) ;
 				esp++ ;
 				esi = *(void **)esp ;
 				esp += STRIDE ;
@@ -1989,6 +2177,7 @@ VAR xeq (void)
 #endif
 					proptr[0] = 0 ;
 					fnptr[0] = 0 ;
+					clrhash () ;
 				    }
 				}
 				break ;
@@ -2124,21 +2313,23 @@ VAR xeq (void)
 						else
 						    {
 							VAR v ;
-							char al, *p ;
-							int eof ;
+							char *p ;
+							long long room ;
+							int eof, n, max = 0x7FFFFFFF ;
 							v.s.t = -1 ;
 							v.s.l = 0 ;
 							v.s.p = 0 ;
 							stores (v, ptr, type) ; // May affect pfree
 							p = pfree + 3 + (char *) zero ;
 							v.s.p = p - (char *) zero ;
-							while (((al = osbget (chan, &eof)) != 0x0D) &&
-								(eof == 0))
-							    {
-								*p++ = al ;
-								if ((p + STACK_NEEDED) > (char *)esp)
-									error (0, NULL) ; // 'No room'
-							    }
+							room = (char *)esp - STACK_NEEDED - p ;
+							if (room < max)
+								max = (room > 0) ? room : 0 ;
+							n = osbgets (chan, p, max, 0x0D, &eof) ;
+							p += n ;
+							if ((n == max) && !eof &&
+							    osbgets (chan, p, 1, 0x0D, &eof))
+								error (0, NULL) ; // 'No room'
 							v.s.l = p - (char *) zero - v.s.p ;
 							stores (v, ptr, type) ;
 						    }
@@ -2893,6 +3084,7 @@ VAR xeq (void)
 				{
 				void *ptr ;
 				unsigned char type ;
+				int fast ;
 				VAR v ;
 
 				ptr = getvar (&type) ;
@@ -2910,6 +3102,7 @@ VAR xeq (void)
 				*--esp = (int) type ;
 
 				v = exprn () ; // limit
+				fast = (type == 4) && (v.i.t == 0) ;
 				*--esp = (int)v.i.t ;
 				esp -= 2 ;
 				*(long long *) esp = v.i.n ;
@@ -2926,6 +3119,7 @@ VAR xeq (void)
 					v.i.t = 0 ;
 					v.i.n = 1 ;
 				    }
+				fast = fast && (v.i.t == 0) && (v.i.n == (int) v.i.n) ;
 				*--esp = (int)v.i.t ;
 				esp -= 2 ;
 				*(long long *) esp = v.i.n ;
@@ -2937,6 +3131,8 @@ VAR xeq (void)
 				esp -= STRIDE ;
 				*(void **)esp = esi ;
 				*--esp = FORCHK ;
+				if (fast)
+					*(int *)(esp + 8 + STRIDE) |= FORINT ;
 				check () ;
 				}
 				break ;
@@ -2958,7 +3154,13 @@ VAR xeq (void)
 					signed char al = *esi ;
 					int b ;
 
-					if ((al != ':') && (al != 0x0D) &&
+					if ((al >= '@') && (al <= 'Z') && (*(esi + 1) == '%') &&
+					    (*(esi + 2) != '(') && (*(esi + 2) != '%'))
+					    { // Static integer variable (bypass getvar)
+						ptr = &stavar[al - '@'] ;
+						esi += 2 ;
+					    }
+					else if ((al != ':') && (al != 0x0D) &&
 					    (al != TELSE) && (al != ','))
 						ptr = getvar (&type) ;
 
@@ -3005,60 +3207,74 @@ VAR xeq (void)
 						    }
 					    }
 
-					type = (char) (int) *(esp + 8 + STRIDE) ;
-					v = loadn (ptr, type) ;
-					s.i.t = *(short *)(esp + 4 + STRIDE) ;
-					s.i.n = *(long long *)(esp + 2 + STRIDE) ;
-#if defined __GNUC__ && __GNUC__ < 5
-					if ((v.i.t == 0) && (s.i.t == 0) && ((((tmpll = v.i.n + s.i.n) ^
-						             v.i.n) >= 0) || ((int)(v.s.l ^ s.s.l) < 0)))
-#else
-					if ((v.i.t == 0) && (s.i.t == 0) &&
-					    (! __builtin_saddll_overflow (v.i.n, s.i.n, &tmpll)))
-#endif
-						 v.i.n = tmpll ;
-					else
+					if (*(int *)(esp + 8 + STRIDE) & FORINT)
 					    {
-						if (v.i.t == 0)
-						    {
-							v.i.t = 1 ; // ARM
-							v.f = v.i.n ;
-						    }
-						if (s.i.t == 0)
-						    {
-							s.i.t = 1 ; // ARM
-							s.f = s.i.n ;
-						    }
-						v.f += s.f ;
-					    }
-					storen (v, ptr, type) ;
-
-					al = *(signed char *)(esp + 1 + STRIDE) ;
-					L.i.t = *(short *)(esp + 7 + STRIDE) ;
-					L.i.n = *(long long*)(esp + 5 + STRIDE) ;
-					if ((v.i.t == 0) && (L.i.t == 0))
-					    {
-						if (al)
-							b = v.i.n > L.i.n ;
+						long long n = (long long) ILOAD(ptr) + *(long long *)(esp + 2 + STRIDE) ;
+						if (n != (int) n)
+							error (20, NULL) ; // 'Number too big'
+						ISTORE(ptr, (int) n) ;
+						if (*(signed char *)(esp + 1 + STRIDE))
+							b = n > *(long long *)(esp + 5 + STRIDE) ;
 						else
-							b = v.i.n < L.i.n ;
+							b = n < *(long long *)(esp + 5 + STRIDE) ;
 					    }
 					else
 					    {
-						if (v.i.t == 0)
+						type = (char) (int) *(esp + 8 + STRIDE) ;
+						v = loadn (ptr, type) ;
+						s.i.t = *(short *)(esp + 4 + STRIDE) ;
+						s.i.n = *(long long *)(esp + 2 + STRIDE) ;
+#if defined __GNUC__ && __GNUC__ < 5
+						if ((v.i.t == 0) && (s.i.t == 0) && ((((tmpll = v.i.n + s.i.n) ^
+							             v.i.n) >= 0) || ((int)(v.s.l ^ s.s.l) < 0)))
+#else
+						if ((v.i.t == 0) && (s.i.t == 0) &&
+						    (! __builtin_saddll_overflow (v.i.n, s.i.n, &tmpll)))
+#endif
+							 v.i.n = tmpll ;
+						else
 						    {
-							v.i.t = 1 ; // ARM
-							v.f = v.i.n ;
+							if (v.i.t == 0)
+							    {
+								v.i.t = 1 ; // ARM
+								v.f = v.i.n ;
+							    }
+							if (s.i.t == 0)
+							    {
+								s.i.t = 1 ; // ARM
+								s.f = s.i.n ;
+							    }
+							v.f += s.f ;
 						    }
-						if (L.i.t == 0)
+						storen (v, ptr, type) ;
+
+						al = *(signed char *)(esp + 1 + STRIDE) ;
+						L.i.t = *(short *)(esp + 7 + STRIDE) ;
+						L.i.n = *(long long*)(esp + 5 + STRIDE) ;
+						if ((v.i.t == 0) && (L.i.t == 0))
 						    {
-							L.i.t = 1 ; // ARM
-							L.f = L.i.n ;
+							if (al)
+								b = v.i.n > L.i.n ;
+							else
+								b = v.i.n < L.i.n ;
 						    }
-						if (al)
-							b = v.f > L.f ;
 						else
-							b = v.f < L.f ;
+						    {
+							if (v.i.t == 0)
+							    {
+								v.i.t = 1 ; // ARM
+								v.f = v.i.n ;
+							    }
+							if (L.i.t == 0)
+							    {
+								L.i.t = 1 ; // ARM
+								L.f = L.i.n ;
+							    }
+							if (al)
+								b = v.f > L.f ;
+							else
+								b = v.f < L.f ;
+						    }
 					    }
 
 					if (b)
@@ -3481,7 +3697,7 @@ VAR xeq (void)
 				{
 				int ni = 0, nf = 0 ;
 				heapptr *oldesp = esp ;
-				VAR v = expr () ;
+				VAR v ;
 				long long (*func) (size_t, size_t, size_t, size_t, size_t, size_t, 
 						   size_t, size_t, size_t, size_t, size_t, size_t) ;
 				PARM parm ;
@@ -3490,20 +3706,26 @@ VAR xeq (void)
 				parm.f[0] = -1.7e308 ;
 				parm.i[0] = 0 ;
 
-				if (v.s.t == -1)
+				nxt () ;
+				func = sysfind () ; // SYS "name", cached per site
+				if (func == NULL)
 				    {
-					if (v.s.l > 255)
-						error (19, NULL) ; // 'String too long'
-					memcpy (accs, v.s.p + zero, v.s.l) ;
-					*(accs + v.s.l) = 0 ;
-					func = sysadr (accs) ;
-					if (func == NULL)
-						error (51, NULL) ; // 'No such system call'
+					v = expr () ;
+					if (v.s.t == -1)
+					    {
+						if (v.s.l > 255)
+							error (19, NULL) ; // 'String too long'
+						memcpy (accs, v.s.p + zero, v.s.l) ;
+						*(accs + v.s.l) = 0 ;
+						func = sysadr (accs) ;
+						if (func == NULL)
+							error (51, NULL) ; // 'No such system call'
+					    }
+					else if (v.i.t == 0)
+						func = (void *)(size_t) v.i.n ;
+					else
+						func = (void *)(size_t) v.f ;
 				    }
-				else if (v.i.t == 0)
-					func = (void *)(size_t) v.i.n ;
-				else
-					func = (void *)(size_t) v.f ;
 
 #ifndef __EMSCRIPTEN__
 				if ((size_t)func < 0x10000)
@@ -3578,6 +3800,7 @@ VAR xeq (void)
 				    }
 
 				v.i.t = 0 ;
+				sysesp = esp ;
 				if (type == 8)
 				    {
 					v.i.t = 1 ; // ARM
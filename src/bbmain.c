@@ -10,6 +10,7 @@
 \*****************************************************************/
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
 #include <setjmp.h>
@@ -21,11 +22,21 @@ void osline (char *) ;		// Read line of input
 void reset (void) ;		// Prepare for reporting an error
 void faterr (const char *) ;	// Report a 'fatal' error message
 void trap (void) ;		// Test for ESCape
+void *sysadr (char *) ;		// Get the address of an API function
 void osload (char*, void*, int) ; // Load a file to memory
 void ossave (char*, void*, int) ; // Save a file from memory
 int osopen (int, char *) ;	// Open a file
 unsigned char osbget (int, int*) ; // Read a byte from a file
 void osshut (int) ;		// Close file(s)
+long long osgbpb (int, void *, void *, long long, long long) ; // Block transfer
+void *mapfile (void *) ;	// Memory-map a channel
+int readpix (int, int, int, int, int *, int) ; // Bulk pixel read
+int arrstats (void *, int, int, double *) ; // Array min, max, mean
+int memsrch (const char *, int, const char *, int) ; // Find first
+int memrsrch (const char *, int, const char *, int) ; // Find last
+int memcount (const char *, int, const char *, int) ; // Count occurrences
+int strsplit (const char *, int, const char *, int, STR *, int) ; // Split fields
+long long *evalstats (int) ; // EVAL cache hits and misses
 
 // Routines in bbccli:
 void oscli (char*) ;            // Command Line Interface
@@ -33,14 +44,62 @@ void oscli (char*) ;            // Command Line Interface
 // Routines in bbexec:
 VAR xeq (void) ;		// Execute program
 
+// Forward references:
+void clrhash (void) ;		// Discard hashed variable index
+void clrlin (void) ;		// Invalidate line-number index
+int defrag (int, int) ;		// Coalesce string free lists
+static void clrsite (signed char *) ;
+static void sitesave (unsigned int, signed char *, void *, unsigned char) ;
+void sysflush (void) ;		// Empty the SYS call-site cache
+
 // Routines in bbeval:
 long long itemi (void);		// Return an integer numeric item
 long long expri (void);		// Evaluate an integer numeric expression
 long long loadi (void *, unsigned char) ;
+void clrcon (signed char *) ;	// Empty the numeric constant cache
 
 // Global jump buffer:
 jmp_buf env ;
 
+// Hashed index to dynamic variables, FNs and PROCs:
+#ifdef PICO
+#define VHSIZE 256
+#else
+#define VHSIZE 8192
+#endif
+static struct { heapptr link ; unsigned int hash ; } vhash[VHSIZE] ;
+static int vhused ;
+static long long vhstat[6] ; // hits, misses, inserts, flushes, used, size
+
+// Per-site cache of variable, FN and PROC addresses (*TURBO ON).
+// Sites are program addresses between PAGE and TOP, which can only
+// change (by editing, LOAD, CHAIN etc.) when clear() is called:
+#ifdef PICO
+#define SCBITS 6
+#else
+#define SCBITS 12
+#endif
+#define SCSIZE (1 << SCBITS)
+static struct { heapptr site ; heapptr ptr ; unsigned char type ; unsigned char len ; } scache[SCSIZE] ;
+static int scused ;
+static heapptr sclo, schi ;	// Range of cacheable sites
+unsigned char fastxq ;		// Non-zero enables the per-site cache
+
+// Per-site cache of SYS "name" addresses (see sysfind):
+#define SYSBITS 6
+static struct { heapptr site ; unsigned char len ; void *addr ; } sycache[1 << SYSBITS] ;
+static int syused ;
+
+// The esp register isn't preserved by apicall_, so an interpreter function
+// called using SYS which allocates strings must use this copy instead:
+heapptr *sysesp ;
+
+// Index of program line addresses, for GOTO, GOSUB and RESTORE:
+static heapptr *lindex ;	// Line offsets in program order
+static int lsize ;		// Allocated size of index
+static int lcount = -2 ;	// Lines indexed (-1 = unusable, -2 = invalid)
+static heapptr lpage ;		// Value of PAGE when index built
+
 #if defined __llvm__ || defined __riscv__
 signed char *esi ;		// Program pointer
 heapptr *esp ;			// Stack pointer
@@ -642,6 +701,10 @@ void clear (void)
 	pfree = lomem + 4 * fastvars ;
 	memset (dynvar, 0, 4 * (54 + 2)) ;
 	memset (flist, 0, sizeof(void *) * 33 + 8) ;
+	clrhash () ;
+	clrlin () ;
+	clrsite (top) ;
+	clrcon (top) ;
         // link00 is a non-aligned 32-bit word 
         for(i=0; i<4; i++)
             ((volatile char *)&link00)[i]=0;
@@ -678,10 +741,45 @@ unsigned short setlin (signed char *edx, char **pebp)
 	return SLOAD(tmp + 1) ;
 }
 
-// Find a specified numbered line in the program by
-// searching from the beginning.  The performance of
-// GOTO, GOSUB and RESTORE is critically dependent
-// on the speed of this routine.
+// Build the line-number index, returning the number of lines
+// indexed or -1 if the lines are not in ascending order:
+static int linidx (void)
+{
+	int n = 0 ;
+	unsigned short lino = 0 ;
+	signed char *ebx = vpage + (signed char *) zero ;
+	while (*ebx)
+	    {
+		if (SLOAD(ebx + 1) < lino)
+			return -1 ;
+		lino = SLOAD(ebx + 1) ;
+		if (n >= lsize)
+		    {
+			heapptr *tmp = realloc (lindex, (lsize + 1024) * sizeof(heapptr)) ;
+			if (tmp == NULL)
+				return -1 ;
+			lindex = tmp ;
+			lsize += 1024 ;
+		    }
+		lindex[n++] = ebx - (signed char *) zero ;
+		ebx += (int)*(unsigned char *)ebx ;
+	    }
+	lpage = vpage ;
+	return n ;
+}
+
+// Invalidate the line-number index (called when the program is edited):
+void clrlin (void)
+{
+	lcount = -2 ;
+}
+
+// Find a specified numbered line in the program.  The
+// performance of GOTO, GOSUB and RESTORE is critically
+// dependent on the speed of this routine, so an index of
+// line addresses is built on first use after the program
+// is changed and binary-searched, otherwise by searching
+// from the beginning.
 // Can optionally be entered with a target address.
 signed char * findl (unsigned int edx)
 {
@@ -697,6 +795,26 @@ signed char * findl (unsigned int edx)
 		return NULL ;
 	    }
 	edx &= 0xFFFF ;
+	if ((lcount == -2) || (lpage != vpage))
+		lcount = linidx () ;
+	if (lcount > 0)
+	    {
+		int lo = 0, hi = lcount ;
+		while (lo < hi)
+		    {
+			int mid = (lo + hi) >> 1 ;
+			if (edx > SLOAD(lindex[mid] + (signed char *) zero + 1))
+				lo = mid + 1 ;
+			else
+				hi = mid ;
+		    }
+		if (lo < lcount)
+		    {
+			signed char *tmp = lindex[lo] + (signed char *) zero ;
+			if (edx == SLOAD(tmp + 1))
+				return tmp ;
+		    }
+	    }
 	while (edx > SLOAD(ebx + 1))
 		ebx += (int)*(unsigned char *)ebx ; 
 	if (edx == SLOAD(ebx + 1))
@@ -734,8 +852,54 @@ unsigned short report (void)
 	return lino ;
 }
 
+// Spare nodes made by defrag, so that takefree can split blocks:
+#define NSPARE 32
+
+// Free-list statistics (see heapstats):
+static long long hpstat[36] ;
+
+// Address range of a free string block (or coalesced run of blocks):
+typedef struct { char *lo ; char *hi ; } extent ;
+
+static int extcmp (const void *a, const void *b)
+{
+	const char *p = ((const extent *) a)->lo, *q = ((const extent *) b)->lo ;
+	return (p > q) - (p < q) ;
+}
+
+// Take a block of at least class n from the free lists, splitting a larger
+// one if necessary (the upper halves go back on the lists while there are
+// spare nodes to hold them).  Returns NULL if there is none:
+static char *takefree (int n)
+{
+	char *addr ;
+	node *head ;
+	int i ;
+
+	for (i = n; (i <= 32) && (flist[i] == NULL); i++) ;
+	if ((n == 0) || (i > 32))
+		return NULL ;
+	head = flist[i] ;
+	flist[i] = head->next ;
+	addr = head->data ;
+	head->next = flist[0] ;
+	flist[0] = head ; // node is now spare
+	while ((i-- > n) && flist[0])
+	    {
+		head = flist[0] ;
+		flist[0] = head->next ;
+		head->data = addr + ((size_t) 1 << i) ;
+		head->next = flist[i] ;
+		flist[i] = head ;
+	    }
+	return addr ;
+}
+
 // Free old string (if any) pointed to by descriptor,
-// allocate space for new string and update descriptor:
+// allocate space for new string and update descriptor.
+// A block of class n (length 2^(n-1) to 2^n - 1, n >= 2) occupies
+// exactly 2^n bytes and is 4-byte aligned, like the list nodes, so
+// adjacent free blocks and nodes can be coalesced:
 char * allocs (unsigned int *ps, int len)
 {
 	char *addr ;
@@ -743,9 +907,9 @@ char * allocs (unsigned int *ps, int len)
 	int new = 0, old = 0, size ;
 
 	if (len)
-		new = 32 - __builtin_clz (len) ;
+		new = len > 1 ? 32 - __builtin_clz (len) : 2 ;
 	if (ULOAD(ps+1))
-		old = 32 - __builtin_clz (ULOAD(ps+1)) ;
+		old = ULOAD(ps+1) > 1 ? 32 - __builtin_clz (ULOAD(ps+1)) : 2 ;
 	USTORE(ps+1, len) ;
 
 // if old and new strings have the same allocation, just change the length:
@@ -755,7 +919,7 @@ char * allocs (unsigned int *ps, int len)
 		return ULOAD(ps) + (char *) zero ; 
 	    }
 
-	size = ((1 << new) - 1) ; // new allocation
+	size = new ? (1 << new) : 0 ; // new allocation
 
 // the allocations differ: so first see if new allocation is in free list;
 // if it is, just swap with old allocation:
@@ -776,11 +940,10 @@ char * allocs (unsigned int *ps, int len)
 // It is extremely important that a block in the free list is used *
 // IN PREFERENCE TO expanding into the heap.
 
-	if (old && ((ULOAD(ps) + (1 << old) - 1) == pfree))
+	addr = ULOAD(ps) + (char *) zero ;
+	if (old && ((addr + (1 << old)) == (pfree + (char *) zero)) &&
+	    (size <= ((char *)esp - addr - STACK_NEEDED)))
 	    {
-		addr = ULOAD(ps) + (char *) zero ;
-		if (size > ((char *)esp - addr - STACK_NEEDED))
-			error (0, NULL) ; // 'No room'
 		pfree = addr + size - (char *) zero ;
 		return addr ;
 	    }
@@ -805,16 +968,131 @@ char * allocs (unsigned int *ps, int len)
 		flist[old] = head ;
 	    }
 
-// allocate new string space from the heap:
+// allocate new string space from the heap, or failing that from
+// the coalesced free lists:
 
-	addr = ((pfree + 1) & -2) + (char *) zero ; // Unicode align
+	addr = ((pfree + 3) & -4) + (char *) zero ; // Unicode align, and see defrag
 	if (size > ((char *)esp - addr - STACK_NEEDED))
-		error (0, NULL) ; // 'No room'
+	    {
+		defrag (0, 16) ;
+		addr = takefree (new) ;
+		if (addr == NULL)
+			error (0, NULL) ; // 'No room'
+		USTORE(ps, addr - (char *) zero) ;
+		return addr ;
+	    }
 	pfree = addr + size - (char *) zero ;
 	USTORE(ps, addr - (char *) zero) ;
 	return addr ;
 }
 
+// Coalesce adjacent free string blocks, and the list nodes themselves, and
+// divide the result into blocks no larger than class most, each preceded by
+// its new node (live strings are not moved).  If trim is set free space at
+// the top of the heap is also given back, which changes pfree.  Returns the
+// number of bytes given back:
+int defrag (int trim, int most)
+{
+	heapptr oldfree = pfree ;
+	extent *ext ;
+	node *head ;
+	int i, j, n = 0 ;
+
+	for (i = 0; i <= 32; i++)
+		for (head = flist[i]; head; head = head->next)
+			n += (i != 0) + 1 ;
+	if (n == 0)
+		return 0 ;
+	ext = malloc (n * sizeof(extent)) ;
+	if (ext == NULL)
+		return 0 ;
+
+	n = 0 ;
+	for (i = 0; i <= 32; i++)
+	    {
+		for (head = flist[i]; head; head = head->next)
+		    {
+			if (i)
+			    {
+				ext[n].lo = head->data ;
+				ext[n++].hi = head->data + ((size_t) 1 << i) ;
+			    }
+			ext[n].lo = (char *) head ;
+			ext[n++].hi = (char *)(head + 1) ;
+		    }
+		flist[i] = NULL ;
+	    }
+	qsort (ext, n, sizeof(extent), extcmp) ;
+
+	for (i = 0, j = 0; i < n; i++)
+		if (j && (ext[j - 1].hi == ext[i].lo))
+			ext[j - 1].hi = ext[i].hi ;
+		else
+			ext[j++] = ext[i] ;
+	n = j ;
+
+	if (trim)
+		while (n && (ext[n - 1].hi == pfree + (char *) zero))
+			pfree = ext[--n].lo - (char *) zero ;
+
+	for (i = 0, j = 0; i < n; i++)
+	    {
+		char *p = ext[i].lo ;
+		while ((j < NSPARE) && ((size_t)(ext[i].hi - p) >= sizeof(node) + 3))
+		    {
+			head = (node *)(((size_t) p + 3) & -4) ;
+			p = (char *)(head + 1) ;
+			head->next = flist[0] ; // spare nodes, for takefree
+			flist[0] = head ;
+			j++ ;
+		    }
+		while ((size_t)(ext[i].hi - p) >= sizeof(node) + 7)
+		    {
+			head = (node *)(((size_t) p + 3) & -4) ;
+			p = (char *)(head + 1) ;
+			j = 63 - __builtin_clzll (ext[i].hi - p) ;
+			if (j > most)
+				j = most ;
+			head->data = p ;
+			head->next = flist[j] ;
+			flist[j] = head ;
+			p += (size_t) 1 << j ;
+		    }
+	    }
+
+	free (ext) ;
+	hpstat[35]++ ;
+	return oldfree - pfree ;
+}
+
+// Return free-list statistics, accessible from BASIC as
+// SYS "BBC_HeapStats" TO stats%%.  Elements are the number of spare nodes,
+// the number of free blocks in each class 1 to 32, the total free bytes,
+// the heap in use (pfree - lomem) and the number of defragmentations:
+long long *heapstats (void)
+{
+	node *head ;
+	int i ;
+
+	memset (hpstat, 0, 35 * sizeof(long long)) ;
+	for (i = 0; i <= 32; i++)
+		for (head = flist[i]; head; head = head->next)
+		    {
+			hpstat[i]++ ;
+			if (i)
+				hpstat[33] += (long long) 1 << i ;
+		    }
+	hpstat[34] = pfree - lomem ;
+	return hpstat ;
+}
+
+// Coalesce the free lists and give back any free space at the top of the
+// heap, accessible from BASIC as SYS "BBC_HeapCompact" TO freed%:
+int heapcompact (void)
+{
+	return defrag (1, 16) ; // longest string is 65535
+}
+
 // Allocate memory for a temporary string:
 //  For lengths < ACCSLEN use the string accumulator
 //  For lengths >= ACCSLEN allocate from the heap
@@ -1039,35 +1317,113 @@ void * putdef (void *ebx)
 	return ebx ;
 }
 
+// Test whether the name at esi matches a single linked-list entry.
+// If so advance esi past the name and return pointer to terminator,
+// otherwise leave esi unchanged and return NULL:
+static void *matchll (heapptr *base, signed char *edi)
+{
+	signed char al ;
+	signed char *save = esi ;
+
+	edi += 4 ;  // skip link
+	while (*esi++ == *edi++) ;
+	esi-- ; edi-- ;
+	al = *edi ; // first character not to match
+	if (((al == 0) && !range0(*esi)) ||	// full match
+            ((al == 0) && (*(esi-1) == '(')) ||	// array
+	    ((al == 0) && (*esi != '%') && (*esi != '(') && !range1(*(esi-1))) || // PRINT a#b
+	    ((al == '{') && (*++edi == 0) && (*esi == '.')) || // structure member
+	    ((al == '%') && (base == NULL) && (*(esi-1) == '%') && (*esi != '(') && (*++edi == 0)) ||
+	    ((al == '%') && (base == NULL) && (*(esi-1) == '%') && (*esi == '(') && 
+					(*++edi == '(') && (*++edi == 0)))
+	    {
+		if (*(esi-1) == '(')
+			esi-- ;
+		return edi + 1 ;
+	    }
+	esi = save ;
+	return NULL ;
+}
+
+// Hash the name at esi (up to its type character); the list number
+// (0-55) occupies the top six bits so that equal hashes imply the
+// same list, which matters because a candidate entry is verified
+// only against the name, not against its list membership:
+static unsigned int hashll (heapptr *base)
+{
+	signed char *p = esi ;
+	unsigned int h = 2166136261U ;
+	while (range1 (*p))
+		h = (h ^ *(unsigned char *)p++) * 16777619U ;
+	h = (h ^ *(unsigned char *)p) * 16777619U ;
+	return (h & 0x03FFFFFF) | ((unsigned int)(base - dynvar) << 26) ;
+}
+
+// Discard the hashed index (the linked lists remain definitive):
+void clrhash (void)
+{
+	if (vhused)
+		memset (vhash, 0, sizeof(vhash)) ;
+	vhused = 0 ;
+	vhstat[3]++ ;
+}
+
+// Return (and optionally reset) the hashed index statistics,
+// accessible from BASIC as SYS "BBC_VarStats", reset% TO stats%%
+long long *varstats (int reset)
+{
+	vhstat[4] = vhused ;
+	vhstat[5] = VHSIZE ;
+	if (reset)
+		memset (vhstat, 0, 4 * sizeof(long long)) ;
+	return vhstat ;
+}
+
 // Scan linked-list for variable etc. (used for regular dynamic variables,
 // system variables, structure members, function and procedure definitions).
-// If found move to head of list unless sysvar or structure (base link = 0).
-// Return pointer to terminator character:
+// Dynamic variables, functions and procedures are first looked up in the
+// hashed index, which is populated only from successful list scans.
+// If found by scanning move to head of list unless sysvar or structure
+// (base link = 0).  Return pointer to terminator character:
 static void *scanll (heapptr *base, signed char *edi)
 {
-	signed char al ;
-	signed char *save = esi ;
-	void *prev = NULL, *this ;
+	void *prev = NULL, *this, *ptr ;
+	unsigned int hash = 0, slot = 0 ;
 	int next ; // n.b. signed for relative links
 
 	if (base && (edi < ((signed char *) zero + 6)))
 		return NULL ; // not found
 
+	if (base)
+	    {
+		hash = hashll (base) ;
+		slot = hash & (VHSIZE - 1) ;
+		while (vhash[slot].link)
+		    {
+			if ((vhash[slot].hash == hash) &&
+			    ((ptr = matchll (base, vhash[slot].link + (signed char *) zero)) != NULL))
+			    {
+				vhstat[0]++ ;
+				return ptr ;
+			    }
+			slot = (slot + 1) & (VHSIZE - 1) ;
+		    }
+		vhstat[1]++ ;
+	    }
+
 	do
 	    {
 		this = edi ;
-		edi += 4 ;  // skip link
-		while (*esi++ == *edi++) ;
-		esi-- ; edi-- ;
-		al = *edi ; // first character not to match
-		if (((al == 0) && !range0(*esi)) ||	// full match
-                    ((al == 0) && (*(esi-1) == '(')) ||	// array
-		    ((al == 0) && (*esi != '%') && (*esi != '(') && !range1(*(esi-1))) || // PRINT a#b
-		    ((al == '{') && (*++edi == 0) && (*esi == '.')) || // structure member
-		    ((al == '%') && (base == NULL) && (*(esi-1) == '%') && (*esi != '(') && (*++edi == 0)) ||
-		    ((al == '%') && (base == NULL) && (*(esi-1) == '%') && (*esi == '(') && 
-						(*++edi == '(') && (*++edi == 0)))
+		ptr = matchll (base, edi) ;
+		if (ptr != NULL)
 		    {
+			if (base && (vhused < (VHSIZE * 3 / 4)))
+			    {
+				vhash[slot].link = this - zero ;
+				vhash[slot].hash = hash ;
+				vhused++ ;
+				vhstat[2]++ ;
+			    }
 			if (base && prev && ((this - zero) != *base))
 			    {
 				next = ULOAD(base) ;
@@ -1075,11 +1431,8 @@ static void *scanll (heapptr *base, signed char *edi)
 				USTORE(prev, ULOAD(this)) ;
 				USTORE(this, next) ;
 			    }
-			if (*(esi-1) == '(')
-				esi-- ;
-			return edi + 1 ;
+			return ptr ;
 		    }
-		esi = save ;
 		prev = this ;
 		next = ILOAD(prev) ;
 		if (base)
@@ -1091,6 +1444,118 @@ static void *scanll (heapptr *base, signed char *edi)
 	return NULL ; // not found
 }
 
+// Table of interpreter functions callable using SYS "name":
+static const struct { const char *name ; void *addr ; } systab[] = {
+	{"BBC_ArrayStats", arrstats},
+	{"BBC_EvalStats", evalstats},
+	{"BBC_HeapCompact", heapcompact},
+	{"BBC_HeapStats", heapstats},
+	{"BBC_MapFile", mapfile},
+	{"BBC_MemCount", memcount},
+	{"BBC_MemSearch", memsrch},
+	{"BBC_MemSearchRev", memrsrch},
+	{"BBC_OSGBPB", osgbpb},
+	{"BBC_ReadPixels", readpix},
+	{"BBC_SplitString", strsplit},
+	{"BBC_SysFlush", sysflush},
+	{"BBC_VarStats", varstats},
+	{NULL, NULL}} ;
+
+// Get the address of an interpreter function (called from sysadr):
+void *sysint (char *name)
+{
+	int i ;
+	for (i = 0; systab[i].name != NULL; i++)
+		if (strcmp (name, systab[i].name) == 0)
+			return systab[i].addr ;
+	return NULL ;
+}
+
+// Empty the SYS call-site cache, which must be done if a library is unloaded
+// (SYS "BBC_SysFlush"):
+void sysflush (void)
+{
+	if (syused)
+		memset (sycache, 0, sizeof(sycache)) ;
+	syused = 0 ;
+}
+
+// Get the address of the function named by a SYS string constant at esi,
+// and skip it.  The address is cached per program site, so that repeated
+// calls don't have to look up the name.  Returns NULL, with esi unchanged,
+// if the name isn't a simple string constant:
+void *sysfind (void)
+{
+	signed char *p = esi + 1, *q ;
+	unsigned int slot ;
+	char *name = accs ;
+	void *addr ;
+
+	if (*esi != '"')
+		return NULL ;
+	slot = ((esi - (signed char *) zero) >> 1) & ((1 << SYSBITS) - 1) ;
+	if ((sycache[slot].site == esi - (signed char *) zero) && (sycache[slot].addr != NULL))
+	    {
+		esi += sycache[slot].len ;
+		return sycache[slot].addr ;
+	    }
+
+	while (1)
+	    {
+		if (*p == 0x0D)
+			return NULL ; // let expr report it
+		if ((*p == '"') && (*++p != '"'))
+			break ;
+		if (name >= accs + 255)
+			return NULL ;
+		*name++ = *p++ ;
+	    }
+	*name = 0 ;
+	q = p ;
+	while (*q == ' ')
+		q++ ;
+	if ((*q != ',') && (*q != ':') && (*q != 0x0D) && (*q != TTO) && (*q != TELSE))
+		return NULL ;
+
+	addr = sysadr (accs) ;
+	if (addr == NULL)
+		error (51, NULL) ; // 'No such system call'
+	if ((esi - (signed char *) zero >= sclo) && (q - (signed char *) zero < schi) &&
+	    (q - esi <= 255))
+	    {
+		sycache[slot].site = esi - (signed char *) zero ;
+		sycache[slot].len = q - esi ;
+		sycache[slot].addr = addr ;
+		syused = 1 ;
+	    }
+	esi = q ;
+	return addr ;
+}
+
+// Invalidate the per-site cache and set the range of cacheable sites:
+static void clrsite (signed char *top)
+{
+	if (scused)
+		memset (scache, 0, sizeof(scache)) ;
+	scused = 0 ;
+	sysflush () ;
+	sclo = vpage ;
+	schi = top - (signed char *) zero ;
+}
+
+// Record the result of a variable, FN or PROC lookup at a program site:
+static void sitesave (unsigned int slot, signed char *site, void *ptr, unsigned char type)
+{
+	slot &= SCSIZE - 1 ;
+	if (esi - site > 255)
+		return ;
+	scache[slot].site = site - (signed char *) zero ;
+	scache[slot].ptr = (char *) ptr - (char *) zero ;
+	scache[slot].type = type ;
+	scache[slot].len = esi - site ;
+	scused = 1 ;
+}
+
 // Try to locate a function or procedure, or indirect call
 void *getdef (unsigned char *found)
 {
@@ -1184,9 +1649,24 @@ static void *locate (unsigned char *ptype)
 {
 	void *ebx, *edx ;
 	char *ptr ;
+	signed char *site = esi ;
+	unsigned int slot = 0 ;
 	signed char al = *esi ;
 	*ptype = 0 ;
 
+	if (fastxq && ((site - (signed char *) zero) >= sclo) &&
+		      ((site - (signed char *) zero) < schi))
+	    {
+		slot = ((unsigned int)(site - (signed char *) zero) * 2654435761U) >> (32 - SCBITS) ;
+		if (scache[slot].site == (site - (signed char *) zero))
+		    {
+			*ptype = scache[slot].type ;
+			esi += scache[slot].len ;
+			return scache[slot].ptr + (char *) zero ;
+		    }
+		slot |= SCSIZE ; // flag cacheable
+	    }
+
 	if (al < '@')
 	    { // FN, PROC or fastvar
 		if ((al >= 0x19) && (al <= 0x1F))
@@ -1202,6 +1682,8 @@ static void *locate (unsigned char *ptype)
 		if (*ptype == 0)
 			error (29, NULL) ; // 'No such FN/PROC'
 		*ptype = 36 ;
+		if ((slot & SCSIZE) && range1 (*(site + 1)))
+			sitesave (slot, site, ebx, *ptype) ;
 		return ebx ;
 	    }
 	if ((al <= 'Z') && (*(esi+1) == '%') && (*(esi+2) != '(') && (*(esi+2) != '%'))
@@ -1232,6 +1714,8 @@ static void *locate (unsigned char *ptype)
 		return ebx ;
 
 	*ptype = getype (ptr) ;
+	if ((slot & SCSIZE) && (ebx != NULL))
+		sitesave (slot, site, ptr, *ptype) ;
 	return ptr ;
 }
 
@@ -1726,6 +2210,7 @@ int basic (void *ecx, void *edx, void *prompt)
 
 				case 0x1D: // NEW 
 					*(signed char *)(vpage + zero) = 0 ;
+					clrlin () ;
 					break ;
 
 				case 0x1E: // RENUMBER
@@ -1755,6 +2240,7 @@ int basic (void *ecx, void *edx, void *prompt)
 						lino += hi ;
 						esi += c ;
 					    }
+					clrlin () ;
 					break ;
 
 				case 0x1F: // SAVE
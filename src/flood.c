@@ -61,6 +61,7 @@ static HLINE_NODE*	pLineList ;
 static HLINE_NODE*	pFreeList ;
 static int		LastY ;
 static int		bXSortOn ;
+static int		BoxLeft, BoxRight, BoxTop, BoxBottom ; /* bounds of filled area */
 
 //----------------------------------------------------------------------------
 // Private methods
@@ -390,6 +391,15 @@ static void PushOpposite(int OldX1,int OldX2,int x1,int x2,int y,int dy)
 	PushVisitedLine(x1,x2,y) ;
 }
 
+// Arguments: Coordinates of filled horizontal line.
+static void ExtendBox(int x1, int x2, int y)
+{
+	if (x1 < BoxLeft) BoxLeft = x1 ;
+	if (x2 > BoxRight) BoxRight = x2 ;
+	if (y < BoxTop) BoxTop = y ;
+	if (y > BoxBottom) BoxBottom = y ;
+}
+
 // Arguments: Coordinates of horizontal line and new color of line.
 static void DrawHorizontalLine(unsigned int *pBitmap, int x1, int x2, int y, int w, unsigned int dwValue)
 {
@@ -457,9 +467,10 @@ static int SearchRight(unsigned int *pBitmap, int x, int y, int w, int h, int xm
  *		fill color 32-bits
  *		target color 32-bits
  *		type 0 = flood while target, 1 = flood until target
+ *		returned bounding box of filled pixels (left, top, right, bottom)
 */
 void flood(unsigned int* pBitmap, int x, int y, int w, int h,
-		unsigned int fill_color, unsigned int target_color, int type)
+		unsigned int fill_color, unsigned int target_color, int type, int *box)
 {
 	int dy ;
 	int ChildLeft, ChildRight ;
@@ -470,6 +481,8 @@ void flood(unsigned int* pBitmap, int x, int y, int w, int h,
 	pVisitList = NULL ;
 	pLineList = NULL ;
 	pFreeList = NULL ;
+	BoxLeft = w ; BoxRight = -1 ;
+	BoxTop = h ; BoxBottom = -1 ;
 
 	/* Initialize internal info based on fill type */
 	if (type)
@@ -520,6 +533,7 @@ void flood(unsigned int* pBitmap, int x, int y, int w, int h,
 				pBitmap[ChildRight + y*w] = fill_color ;
 			else
 				DrawHorizontalLine(pBitmap,ChildLeft,ChildRight,y,w,fill_color) ;
+			ExtendBox(ChildLeft,ChildRight,y) ;
 
 			/* Push unvisited lines */
 			if (ParentLeft-1<=ChildLeft && ChildRight<=ParentRight+1)
@@ -609,6 +623,7 @@ void flood(unsigned int* pBitmap, int x, int y, int w, int h,
 					pBitmap[ChildRight + y*w] = fill_color ;
 				else
 					DrawHorizontalLine(pBitmap,ChildLeft,ChildRight,y,w,fill_color) ;
+				ExtendBox(ChildLeft,ChildRight,y) ;
 
 				/* Push unvisited lines */
 				if (ChildRight <= ParentRight+1)
@@ -632,4 +647,7 @@ void flood(unsigned int* pBitmap, int x, int y, int w, int h,
 	}
 
 	FreeList() ;
+
+	box[0] = BoxLeft ; box[1] = BoxTop ;
+	box[2] = BoxRight ; box[3] = BoxBottom ;
 }
@@ -857,10 +857,42 @@ unsigned char osbget(void *chan, int *peof) { // Read a byte from a file
    return _osbget(chan, peof);
 }
 
+int osbgets(void *chan, char *dst, int max, int term, int *peof) { // Read a line
+   int n = 0;
+   while (n < max) {
+      unsigned char al = _osbget(chan, peof);
+      if (*peof) {
+         break;
+      }
+      if ((term >= 0) && ((al == (term & 0xFF)) ||
+            ((al == 0x0D) && (term & 0x8100)) || ((al == 0x0A) && (term & 0x100)))) {
+         break;
+      }
+      dst[n++] = al;
+   }
+   return n;
+}
+
 void osbput(void *chan, unsigned char byte) { // Write a byte to a file
    _osbput(chan, byte);
 }
 
+long long osgbpb(int reason, void *chan, unsigned char *data, long long count, long long ptr) { // Block transfer
+   uint32_t addr = (uint32_t) data;
+   uint32_t num = count;
+   uint32_t p = ptr;
+   int eof = 0;
+   if ((reason < 1) || (reason > 4) || (count < 0)) {
+      error(31, NULL); // 'Incorrect arguments'
+   }
+   _osgbpb(reason, (uint8_t) (uint32_t) chan, &addr, &num, &p, &eof);
+   return count - num;
+}
+
+void *mapfile(void *chan) { // Memory-map a channel (not supported)
+   return NULL;
+}
+
 // MOS - Graphics
 
 unsigned int palette[256];
@@ -894,6 +926,12 @@ int vtint(int x, int y) { // Get RGB pixel colour or -1
    return 0;
 }
 
+int readpix(int x, int y, int w, int h, int *buf, int pal) { // Read pixel rectangle
+   text("TODO: readpix");
+   crlf();
+   return 0;
+}
+
 int widths(unsigned char *s, int l) { // Get string width in graphics units
    text("TODO: widths");
    crlf();
@@ -1,8 +1,17 @@
-// Shell sort
+// Array sort
 // iOS does not permit arbitrary code execution so the code which would normally
 // go in 'sortlib.bbc' is put here to be compiled with the BBC Basic application
 
 #include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Arrays of at least MTSORT elements are merge-sorted by up to four threads:
+#ifndef __EMSCRIPTEN__
+#define SORT_THREADS
+#include <pthread.h>
+#endif
+#define MTSORT 65536
 
 // Base address for 32-bit offsets into heap:
 #if defined(__x86_64__) || defined(__aarch64__) || defined(__arm64__)
@@ -87,7 +96,7 @@ static int compare (void *src, void *dst, unsigned char type)
 	return 0 ;
 }
 
-void sortup (int eax, int ebx, int ecx, unsigned int edx, unsigned int esi, unsigned int edi, void *ebp)
+static void shellup (int ecx, unsigned int edx, unsigned int esi, unsigned int edi, void *ebp)
 {
 	unsigned int gap = 0xFFFFFFFF ;
 	void *savebp = ebp ;
@@ -159,7 +168,7 @@ void sortup (int eax, int ebx, int ecx, unsigned int edx, unsigned int esi, unsi
 	return ;
 }
 
-void sortdn (int eax, int ebx, int ecx, unsigned int edx, unsigned int esi, unsigned int edi, void *ebp)
+static void shelldn (int ecx, unsigned int edx, unsigned int esi, unsigned int edi, void *ebp)
 {
 	unsigned int gap = 0xFFFFFFFF ;
 	void *savebp = ebp ;
@@ -231,6 +240,264 @@ void sortdn (int eax, int ebx, int ecx, unsigned int edx, unsigned int esi, unsi
 	return ;
 }
 
+// Stable sort of an index vector, keyed on one or more arrays.
+// Numeric primary keys are radix sorted, anything else (and ties in the
+// primary key) is merge sorted; the permutation is then applied to every
+// array.  If memory can't be allocated the shell sort above is used.
+
+typedef struct
+{
+	int num ;			// Number of arrays
+	int first ;			// First array to compare
+	int dir ;			// 1 = ascending, -1 = descending
+	unsigned char type[256] ;
+	char *base[256] ;
+} sortctx ;
+
+// Compare elements i and j, giving -1 if i must precede j:
+static int cmpidx (sortctx *ctx, unsigned int i, unsigned int j)
+{
+	int k ;
+	for (k = ctx->first ; k < ctx->num ; k++)
+	    {
+		unsigned char type = ctx->type[k] ;
+		size_t size = type & 15 ;
+		int result = compare (ctx->base[k] + j * size, ctx->base[k] + i * size, type) ;
+		if (result)
+			return result * ctx->dir ;
+	    }
+	return 0 ;
+}
+
+static void msort (unsigned int *idx, unsigned int *tmp, unsigned int n, sortctx *ctx, int depth) ;
+
+#ifdef SORT_THREADS
+typedef struct { unsigned int *idx ; unsigned int *tmp ; unsigned int n ; sortctx *ctx ; int depth ; } sortarg ;
+
+static void *mthread (void *arg)
+{
+	sortarg *p = arg ;
+	msort (p->idx, p->tmp, p->n, p->ctx, p->depth) ;
+	return NULL ;
+}
+#endif
+
+// Merge sort, using tmp (n entries) as workspace:
+static void msort (unsigned int *idx, unsigned int *tmp, unsigned int n, sortctx *ctx, int depth)
+{
+	unsigned int h, i, j, k ;
+
+	if (n <= 16)
+	    {
+		for (i = 1 ; i < n ; i++)
+		    {
+			unsigned int t = idx[i] ;
+			for (j = i ; (j > 0) && (cmpidx (ctx, t, idx[j - 1]) < 0) ; j--)
+				idx[j] = idx[j - 1] ;
+			idx[j] = t ;
+		    }
+		return ;
+	    }
+
+	h = n >> 1 ;
+#ifdef SORT_THREADS
+	if (depth && (n >= MTSORT))
+	    {
+		pthread_t thread ;
+		sortarg arg = {idx, tmp, h, ctx, depth - 1} ;
+		if (pthread_create (&thread, NULL, mthread, &arg) == 0)
+		    {
+			msort (idx + h, tmp + h, n - h, ctx, depth - 1) ;
+			pthread_join (thread, NULL) ;
+		    }
+		else
+		    {
+			msort (idx, tmp, h, ctx, 0) ;
+			msort (idx + h, tmp + h, n - h, ctx, 0) ;
+		    }
+	    }
+	else
+#endif
+	    {
+		msort (idx, tmp, h, ctx, 0) ;
+		msort (idx + h, tmp + h, n - h, ctx, 0) ;
+	    }
+
+	if (cmpidx (ctx, idx[h], idx[h - 1]) >= 0)
+		return ; // already in order
+
+	memcpy (tmp, idx, h * sizeof(unsigned int)) ;
+	i = 0 ; j = h ; k = 0 ;
+	while ((i < h) && (j < n))
+	    {
+		if (cmpidx (ctx, idx[j], tmp[i]) < 0)
+			idx[k++] = idx[j++] ;
+		else
+			idx[k++] = tmp[i++] ;
+	    }
+	while (i < h)
+		idx[k++] = tmp[i++] ;
+}
+
+// Convert an element to an unsigned key with the same ordering:
+static unsigned long long radkey (char *p, unsigned char type)
+{
+	unsigned long long k ;
+	switch (type)
+	    {
+		case 1:
+			return *(unsigned char *)p ;
+
+		case 4:
+			return (unsigned int) *(int *)p ^ 0x80000000 ;
+
+		case 8:
+			memcpy (&k, p, 8) ;
+			if (k == 0x8000000000000000ULL)
+				return 0x8000000000000000ULL ; // -0 == +0
+			if (k & 0x8000000000000000ULL)
+				return ~k ;
+			return k | 0x8000000000000000ULL ;
+	    }
+	memcpy (&k, p, 8) ; // 40
+	return k ^ 0x8000000000000000ULL ;
+}
+
+// LSD radix sort of key/index pairs, skipping passes on uniform bytes:
+static void radix (unsigned long long *key, unsigned int *idx, unsigned long long *tkey,
+		   unsigned int *tidx, unsigned int n, int bytes)
+{
+	static unsigned int count[8][256] ;
+	unsigned long long *k0 = key ;
+	unsigned int i, b ;
+
+	memset (count, 0, sizeof(count)) ;
+	for (i = 0 ; i < n ; i++)
+		for (b = 0 ; b < bytes ; b++)
+			count[b][(key[i] >> (b * 8)) & 0xFF]++ ;
+
+	for (b = 0 ; b < bytes ; b++)
+	    {
+		unsigned int *c = count[b], sum = 0 ;
+		void *t ;
+		if (c[(key[0] >> (b * 8)) & 0xFF] == n)
+			continue ;
+		for (i = 0 ; i < 256 ; i++)
+		    {
+			unsigned int tmp = c[i] ;
+			c[i] = sum ;
+			sum += tmp ;
+		    }
+		for (i = 0 ; i < n ; i++)
+		    {
+			unsigned int d = (key[i] >> (b * 8)) & 0xFF ;
+			tkey[c[d]] = key[i] ;
+			tidx[c[d]++] = idx[i] ;
+		    }
+		t = key ; key = tkey ; tkey = t ;
+		t = idx ; idx = tidx ; tidx = t ;
+	    }
+
+	if (key != k0)
+	    {
+		memcpy (tkey, key, n * sizeof(unsigned long long)) ;
+		memcpy (tidx, idx, n * sizeof(unsigned int)) ;
+	    }
+}
+
+static int fastsort (int ecx, void *ebp, int dir)
+{
+	static sortctx ctx ;
+	unsigned int n = ecx, i, k, size = 0 ;
+	unsigned int *idx, *tmp ;
+	unsigned long long *key = NULL ;
+	char *buf ;
+	int bytes = 0 ;
+
+	ctx.num = *(unsigned char*)ebp++ ; // number of arrays
+	ctx.first = 0 ;
+	ctx.dir = dir ;
+	for (k = 0 ; k < ctx.num ; k++)
+	    {
+		ctx.type[k] = *(unsigned char*)ebp++ ;
+		ctx.base[k] = *(char **)ebp ;
+		ebp += sizeof(void *) ;
+		if ((ctx.type[k] & 15) > size)
+			size = ctx.type[k] & 15 ;
+	    }
+	if (ctx.num == 0)
+		return 1 ;
+
+	switch (ctx.type[0])
+	    {
+		case 1:	bytes = 1 ; break ;
+		case 4: bytes = 4 ; break ;
+		case 8:
+		case 40: bytes = 8 ; break ;
+	    }
+
+	idx = malloc (n * sizeof(unsigned int)) ;
+	tmp = malloc (n * sizeof(unsigned int)) ;
+	buf = malloc ((size_t) n * size) ;
+	if (bytes)
+		key = malloc (2 * (size_t) n * sizeof(unsigned long long)) ;
+	if ((idx == NULL) || (tmp == NULL) || (buf == NULL) || (bytes && (key == NULL)))
+	    {
+		free (idx) ; free (tmp) ; free (buf) ; free (key) ;
+		return 0 ;
+	    }
+
+	for (i = 0 ; i < n ; i++)
+		idx[i] = i ;
+
+	if (bytes)
+	    {
+		unsigned long long mask = 0 ;
+		if (dir < 0)
+			mask = ~0ULL >> (64 - bytes * 8) ; // descending
+		size = ctx.type[0] & 15 ;
+		for (i = 0 ; i < n ; i++)
+			key[i] = radkey (ctx.base[0] + (size_t) i * size, ctx.type[0]) ^ mask ;
+		radix (key, idx, key + n, tmp, n, bytes) ;
+
+		// Resolve ties in the primary key using the other arrays:
+		ctx.first = 1 ;
+		if (ctx.num > 1)
+			for (i = 0 ; i < n ; i = k)
+			    {
+				for (k = i + 1 ; (k < n) && (key[k] == key[i]) ; k++) ;
+				if (k - i > 1)
+					msort (idx + i, tmp, k - i, &ctx, 0) ;
+			    }
+	    }
+	else
+		msort (idx, tmp, n, &ctx, 2) ;
+
+	for (k = 0 ; k < ctx.num ; k++)
+	    {
+		char *base = ctx.base[k] ;
+		size = ctx.type[k] & 15 ;
+		for (i = 0 ; i < n ; i++)
+			memcpy (buf + (size_t) i * size, base + (size_t) idx[i] * size, size) ;
+		memcpy (base, buf, (size_t) n * size) ;
+	    }
+
+	free (idx) ; free (tmp) ; free (buf) ; free (key) ;
+	return 1 ;
+}
+
+void sortup (int eax, int ebx, int ecx, unsigned int edx, unsigned int esi, unsigned int edi, void *ebp)
+{
+	if ((ecx > 1) && !fastsort (ecx, ebp, 1))
+		shellup (ecx, edx, esi, edi, ebp) ;
+}
+
+void sortdn (int eax, int ebx, int ecx, unsigned int edx, unsigned int esi, unsigned int edi, void *ebp)
+{
+	if ((ecx > 1) && !fastsort (ecx, ebp, -1))
+		shelldn (ecx, edx, esi, edi, ebp) ;
+}
+
 // Timer callback
 // iOS does not permit arbitrary code execution so the code which would normally
 // go in 'timerlib.bbc' is put here to be compiled with the BBC Basic application